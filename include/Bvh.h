@@ -0,0 +1,423 @@
+#ifndef BVH_H
+#define BVH_H
+
+// Hierarchia brył otaczających (BVH) nad dowolnymi AABB: stanowiska salonu (CarResidency)
+// albo trójkąty jednej siatki (TriangleBvh).
+//  - budowa: binned SAH (BINS przedziałów na oś), liście do MAX_LEAF obiektów,
+//  - węzły 32-bajtowe w jednej tablicy, dzieci parami (prawe = lewe + 1) i zawsze za rodzicem,
+//    więc refit to jeden przebieg od końca tablicy,
+//  - zapytania: frustum (węzeł w całości w środku = całe poddrzewo bez dalszych testów),
+//    promień (najbliższe trafienie, bliższe dziecko najpierw), najbliższy obiekt do punktu.
+
+#include <glm/glm.hpp>
+
+#include "FrustumCuller.h"
+#include "Vertex.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+struct Aabb {
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+
+    void grow(const glm::vec3 &point) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    void grow(const Aabb &other) {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+    bool valid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+    // Połowa pola powierzchni - stała 2 nie zmienia wyniku SAH
+    float halfArea() const {
+        glm::vec3 e = glm::max(max - min, glm::vec3(0.0f));
+        return e.x * e.y + e.y * e.z + e.z * e.x;
+    }
+
+    // Kwadrat odległości punktu od pudełka (0 w środku)
+    float distanceSquared(const glm::vec3 &point) const {
+        glm::vec3 d = glm::max(glm::max(min - point, point - max), glm::vec3(0.0f));
+        return glm::dot(d, d);
+    }
+
+    // AABB w przestrzeni modelu przekształcone do świata (Arvo)
+    static Aabb transformed(const glm::mat4 &transform, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax) {
+        glm::vec3 center = glm::vec3(transform * glm::vec4((boundsMin + boundsMax) * 0.5f, 1.0f));
+        glm::vec3 half = (boundsMax - boundsMin) * 0.5f;
+        glm::vec3 extent = glm::abs(glm::vec3(transform[0])) * half.x +
+                           glm::abs(glm::vec3(transform[1])) * half.y +
+                           glm::abs(glm::vec3(transform[2])) * half.z;
+        Aabb box;
+        box.min = center - extent;
+        box.max = center + extent;
+        return box;
+    }
+
+    // Test płyt; invDir = 1 / kierunek. Zwraca odległość wejścia (w jednostkach kierunku) albo FLT_MAX.
+    float intersect(const glm::vec3 &origin, const glm::vec3 &invDir, float maxT) const {
+        glm::vec3 t0 = (min - origin) * invDir;
+        glm::vec3 t1 = (max - origin) * invDir;
+        glm::vec3 tNear = glm::min(t0, t1), tFar = glm::max(t0, t1);
+        float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxT));
+        return enter <= exit ? enter : FLT_MAX;
+    }
+};
+
+struct BvhNode {
+    glm::vec3 min;
+    uint32_t leftFirst; // węzeł wewnętrzny: lewe dziecko; liść: pierwszy obiekt w objects()
+    glm::vec3 max;
+    uint32_t count;     // 0 = węzeł wewnętrzny
+
+    bool isLeaf() const { return count > 0; }
+};
+static_assert(sizeof(BvhNode) == 32, "BvhNode ma zajmowac pol linii cache");
+
+class Bvh {
+public:
+    static constexpr int BINS = 12;
+    static constexpr uint32_t MAX_LEAF = 4;
+    static constexpr int MAX_DEPTH = 48; // stos zapytań (64) wystarcza na głębokość + 1
+
+    void build(const std::vector<Aabb> &boxes) {
+        nodes.clear();
+        objectIndices.resize(boxes.size());
+        for(size_t i = 0; i < boxes.size(); i++) objectIndices[i] = static_cast<uint32_t>(i);
+        if(boxes.empty()) return;
+
+        centers.resize(boxes.size());
+        for(size_t i = 0; i < boxes.size(); i++) centers[i] = boxes[i].center();
+
+        nodes.reserve(boxes.size() * 2);
+        nodes.push_back(BvhNode());
+        nodes[0].leftFirst = 0;
+        nodes[0].count = static_cast<uint32_t>(boxes.size());
+        updateBounds(0, boxes);
+        subdivide(0, boxes, 0);
+        centers.clear();
+    }
+
+    // Te same obiekty, nowe pudełka (przesunięte auto, inny model na stanowisku) - topologia bez zmian
+    void refit(const std::vector<Aabb> &boxes) {
+        for(size_t n = nodes.size(); n-- > 0;) {
+            BvhNode &node = nodes[n];
+            if(node.isLeaf()) {
+                updateBounds(static_cast<uint32_t>(n), boxes);
+            } else {
+                const BvhNode &left = nodes[node.leftFirst];
+                const BvhNode &right = nodes[node.leftFirst + 1];
+                node.min = glm::min(left.min, right.min);
+                node.max = glm::max(left.max, right.max);
+            }
+        }
+    }
+
+    // visit(obiekt, częściowo) - częściowo = liść przecina płaszczyznę, obiekt wymaga własnego testu
+    template<typename Visit>
+    void frustum(const Frustum &frustum, Visit visit) const {
+        if(nodes.empty()) return;
+        uint32_t stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while(top > 0) {
+            const BvhNode &node = nodes[stack[--top]];
+            visitedNodes++;
+            int state = classify(frustum, node);
+            if(state < 0) continue;
+            if(state > 0) {
+                visitSubtree(node, visit);
+                continue;
+            }
+            if(node.isLeaf()) {
+                for(uint32_t i = 0; i < node.count; i++) visit(objectIndices[node.leftFirst + i], true);
+            } else {
+                stack[top++] = node.leftFirst;
+                stack[top++] = node.leftFirst + 1;
+            }
+        }
+    }
+
+    // hit(obiekt, maxT) zwraca odległość trafienia albo FLT_MAX; wynik: najbliższy obiekt albo -1
+    template<typename Hit>
+    int raycast(const glm::vec3 &origin, const glm::vec3 &direction, float &distance, Hit hit) const {
+        distance = FLT_MAX;
+        int best = -1;
+        if(nodes.empty()) return best;
+        glm::vec3 invDir = 1.0f / direction;
+        uint32_t stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while(top > 0) {
+            const BvhNode &node = nodes[stack[--top]];
+            visitedNodes++;
+            if(nodeBox(node).intersect(origin, invDir, distance) == FLT_MAX) continue;
+            if(node.isLeaf()) {
+                for(uint32_t i = 0; i < node.count; i++) {
+                    uint32_t object = objectIndices[node.leftFirst + i];
+                    float t = hit(object, distance);
+                    if(t < distance) {
+                        distance = t;
+                        best = static_cast<int>(object);
+                    }
+                }
+                continue;
+            }
+            // Bliższe dziecko na wierzch stosu - wcześniej skraca distance
+            uint32_t closer = node.leftFirst, further = node.leftFirst + 1;
+            float tCloser = nodeBox(nodes[closer]).intersect(origin, invDir, distance);
+            float tFurther = nodeBox(nodes[further]).intersect(origin, invDir, distance);
+            if(tFurther < tCloser) {
+                std::swap(closer, further);
+                std::swap(tCloser, tFurther);
+            }
+            if(tFurther != FLT_MAX) stack[top++] = further;
+            if(tCloser != FLT_MAX) stack[top++] = closer;
+        }
+        return best;
+    }
+
+    // distanceSquared(obiekt) - dokładna odległość obiektu; wynik: najbliższy obiekt albo -1
+    template<typename Distance>
+    int nearest(const glm::vec3 &point, float &bestSquared, Distance distanceSquared) const {
+        bestSquared = FLT_MAX;
+        int best = -1;
+        if(nodes.empty()) return best;
+        uint32_t stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while(top > 0) {
+            const BvhNode &node = nodes[stack[--top]];
+            visitedNodes++;
+            if(nodeBox(node).distanceSquared(point) >= bestSquared) continue;
+            if(node.isLeaf()) {
+                for(uint32_t i = 0; i < node.count; i++) {
+                    uint32_t object = objectIndices[node.leftFirst + i];
+                    float d = distanceSquared(object);
+                    if(d < bestSquared) {
+                        bestSquared = d;
+                        best = static_cast<int>(object);
+                    }
+                }
+                continue;
+            }
+            uint32_t closer = node.leftFirst, further = node.leftFirst + 1;
+            if(nodeBox(nodes[further]).distanceSquared(point) < nodeBox(nodes[closer]).distanceSquared(point)) std::swap(closer, further);
+            stack[top++] = further;
+            stack[top++] = closer;
+        }
+        return best;
+    }
+
+    // Po przepisaniu danych obiektów w kolejności liści: obiekt = pozycja w tej kolejności
+    void renumberObjects() {
+        for(size_t i = 0; i < objectIndices.size(); i++) objectIndices[i] = static_cast<uint32_t>(i);
+    }
+
+    const std::vector<BvhNode>& nodeList() const { return nodes; }
+    const std::vector<uint32_t>& objects() const { return objectIndices; }
+    size_t bytes() const { return nodes.capacity() * sizeof(BvhNode) + objectIndices.capacity() * sizeof(uint32_t); }
+
+    // Odwiedzone węzły od startu (wszystkie zapytania) - do statystyk i benchmarku
+    mutable uint64_t visitedNodes = 0;
+
+private:
+    std::vector<BvhNode> nodes;
+    std::vector<uint32_t> objectIndices;
+    std::vector<glm::vec3> centers; // tylko w trakcie build()
+
+    static Aabb nodeBox(const BvhNode &node) {
+        Aabb box;
+        box.min = node.min;
+        box.max = node.max;
+        return box;
+    }
+
+    void updateBounds(uint32_t index, const std::vector<Aabb> &boxes) {
+        BvhNode &node = nodes[index];
+        Aabb bounds;
+        for(uint32_t i = 0; i < node.count; i++) bounds.grow(boxes[objectIndices[node.leftFirst + i]]);
+        node.min = bounds.min;
+        node.max = bounds.max;
+    }
+
+    // -1 poza frustumem, 0 przecina, 1 w całości w środku
+    static int classify(const Frustum &frustum, const BvhNode &node) {
+        glm::vec3 center = (node.min + node.max) * 0.5f;
+        glm::vec3 extent = (node.max - node.min) * 0.5f;
+        int result = 1;
+        for(const glm::vec4 &plane : frustum.planes) {
+            float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+            float radius = glm::dot(glm::abs(glm::vec3(plane)), extent);
+            if(distance < -radius) return -1;
+            if(distance < radius) result = 0;
+        }
+        return result;
+    }
+
+    template<typename Visit>
+    void visitSubtree(const BvhNode &root, Visit &visit) const {
+        uint32_t stack[64];
+        int top = 0;
+        const BvhNode* node = &root;
+        while(true) {
+            if(node->isLeaf()) {
+                for(uint32_t i = 0; i < node->count; i++) visit(objectIndices[node->leftFirst + i], false);
+            } else {
+                stack[top++] = node->leftFirst + 1;
+                stack[top++] = node->leftFirst;
+            }
+            if(top == 0) break;
+            node = &nodes[stack[--top]];
+        }
+    }
+
+    // Podział węzła: najtańszy z BINS-1 podziałów na każdej osi (koszt = pole * liczba obiektów)
+    void subdivide(uint32_t index, const std::vector<Aabb> &boxes, int depth) {
+        BvhNode node = nodes[index];
+        if(node.count <= MAX_LEAF || depth >= MAX_DEPTH) return;
+
+        Aabb centroidBounds;
+        for(uint32_t i = 0; i < node.count; i++) centroidBounds.grow(centers[objectIndices[node.leftFirst + i]]);
+
+        int bestAxis = -1;
+        int bestSplit = 0;
+        float bestCost = FLT_MAX;
+        for(int axis = 0; axis < 3; axis++) {
+            float lo = centroidBounds.min[axis], hi = centroidBounds.max[axis];
+            if(hi <= lo) continue;
+            Aabb binBounds[BINS];
+            uint32_t binCount[BINS] = {};
+            float scale = BINS / (hi - lo);
+            for(uint32_t i = 0; i < node.count; i++) {
+                uint32_t object = objectIndices[node.leftFirst + i];
+                int bin = std::min(BINS - 1, static_cast<int>((centers[object][axis] - lo) * scale));
+                binCount[bin]++;
+                binBounds[bin].grow(boxes[object]);
+            }
+            // Koszty lewych stron od lewej, prawych od prawej
+            float leftArea[BINS - 1], rightArea[BINS - 1];
+            uint32_t leftCount[BINS - 1], rightCount[BINS - 1];
+            Aabb leftBox, rightBox;
+            uint32_t leftSum = 0, rightSum = 0;
+            for(int i = 0; i < BINS - 1; i++) {
+                leftSum += binCount[i];
+                leftCount[i] = leftSum;
+                leftBox.grow(binBounds[i]);
+                leftArea[i] = leftSum ? leftBox.halfArea() : 0.0f;
+                rightSum += binCount[BINS - 1 - i];
+                rightCount[BINS - 2 - i] = rightSum;
+                rightBox.grow(binBounds[BINS - 1 - i]);
+                rightArea[BINS - 2 - i] = rightSum ? rightBox.halfArea() : 0.0f;
+            }
+            for(int i = 0; i < BINS - 1; i++) {
+                float cost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+                if(leftCount[i] > 0 && rightCount[i] > 0 && cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = i;
+                }
+            }
+        }
+
+        // Podział nie opłaca się (albo wszystkie środki w jednym punkcie) - zostaje liść
+        float leafCost = node.count * Aabb{ node.min, node.max }.halfArea();
+        if(bestAxis < 0 || (bestCost >= leafCost && node.count <= 4 * MAX_LEAF)) return;
+
+        float lo = centroidBounds.min[bestAxis];
+        float scale = BINS / (centroidBounds.max[bestAxis] - lo);
+        uint32_t* first = objectIndices.data() + node.leftFirst;
+        uint32_t* middle = std::partition(first, first + node.count, [&](uint32_t object) {
+            return std::min(BINS - 1, static_cast<int>((centers[object][bestAxis] - lo) * scale)) <= bestSplit;
+        });
+        uint32_t leftCount = static_cast<uint32_t>(middle - first);
+
+        uint32_t left = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(BvhNode());
+        nodes.push_back(BvhNode());
+        nodes[left].leftFirst = node.leftFirst;
+        nodes[left].count = leftCount;
+        nodes[left + 1].leftFirst = node.leftFirst + leftCount;
+        nodes[left + 1].count = node.count - leftCount;
+        nodes[index].leftFirst = left;
+        nodes[index].count = 0;
+        updateBounds(left, boxes);
+        updateBounds(left + 1, boxes);
+
+        subdivide(left, boxes, depth + 1);
+        subdivide(left + 1, boxes, depth + 1);
+    }
+};
+
+// BVH trójkątów jednej siatki (LOD0) - dokładne trafienie promieniem, np. wybór auta w salonie.
+// Trójkąty są przepisane w kolejności liści, więc liść czyta ciągły fragment pamięci.
+class TriangleBvh {
+public:
+    void build(const Vertex* vertices, const unsigned int* indices, size_t indexCount) {
+        size_t triangleCount = indexCount / 3;
+        std::vector<Aabb> boxes(triangleCount);
+        for(size_t t = 0; t < triangleCount; t++)
+            for(int k = 0; k < 3; k++) boxes[t].grow(vertices[indices[t * 3 + k]].Position);
+        bvh.build(boxes);
+
+        triangles.resize(triangleCount * 3);
+        const std::vector<uint32_t> &order = bvh.objects();
+        for(size_t t = 0; t < triangleCount; t++)
+            for(int k = 0; k < 3; k++) triangles[t * 3 + k] = vertices[indices[order[t] * 3 + k]].Position;
+        bvh.renumberObjects();
+    }
+
+    // Odległość trafienia w jednostkach kierunku albo FLT_MAX
+    float raycast(const glm::vec3 &origin, const glm::vec3 &direction) const {
+        float distance;
+        bvh.raycast(origin, direction, distance, [&](uint32_t triangle, float maxT) {
+            return intersect(origin, direction, &triangles[triangle * 3], maxT);
+        });
+        return distance;
+    }
+
+    // AABB wszystkich trójkątów (korzeń BVH)
+    Aabb bounds() const {
+        Aabb box;
+        if(!bvh.nodeList().empty()) {
+            box.min = bvh.nodeList()[0].min;
+            box.max = bvh.nodeList()[0].max;
+        }
+        return box;
+    }
+
+    size_t bytes() const { return bvh.bytes() + triangles.capacity() * sizeof(glm::vec3); }
+    size_t triangleCount() const { return triangles.size() / 3; }
+
+private:
+    Bvh bvh;
+    std::vector<glm::vec3> triangles;
+
+    // Möller-Trumbore, obie strony trójkąta
+    static float intersect(const glm::vec3 &origin, const glm::vec3 &direction, const glm::vec3* v, float maxT) {
+        glm::vec3 edge1 = v[1] - v[0], edge2 = v[2] - v[0];
+        glm::vec3 p = glm::cross(direction, edge2);
+        float det = glm::dot(edge1, p);
+        if(std::abs(det) < 1e-12f) return FLT_MAX;
+        float invDet = 1.0f / det;
+        glm::vec3 s = origin - v[0];
+        float u = glm::dot(s, p) * invDet;
+        if(u < 0.0f || u > 1.0f) return FLT_MAX;
+        glm::vec3 q = glm::cross(s, edge1);
+        float w = glm::dot(direction, q) * invDet;
+        if(w < 0.0f || u + w > 1.0f) return FLT_MAX;
+        float t = glm::dot(edge2, q) * invDet;
+        return t >= 0.0f && t < maxT ? t : FLT_MAX;
+    }
+};
+
+#endif
@@ -0,0 +1,395 @@
+#ifndef CAR_RESIDENCY_H
+#define CAR_RESIDENCY_H
+
+// Strumieniowanie aut po salonie:
+//  - model (car-N) jest wczytywany raz i wspólny dla wszystkich stanowisk z tą samą ścieżką;
+//    stanowiska różnią się tylko macierzą i warstwą lakieru (rysowanie instancjami),
+//  - model ładuje się, gdy kamera podejdzie do któregoś z jego stanowisk (LOAD_RADIUS),
+//  - pamięć GPU (geometria; tekstury aut są we wspólnej TextureLibrary) i CPU jest liczona na bieżąco;
+//    po przekroczeniu budżetu zwalniamy modele najdawniej widziane (LRU po numerze klatki,
+//    w której były w frustumie),
+//  - model niewczytany rysuje się jako pudełko o wymiarach z ostatniego wczytania (pośrednik),
+//  - stanowiska są w BVH (AABB w świecie): frustum, wybór promieniem i najbliższe auto bez przeglądania
+//    wszystkich stanowisk; zmiana pudełek (przestawione auto, wczytany model) to tylko refit.
+
+#include "Bvh.h"
+#include "FrustumCuller.h"
+#include "OcclusionCuller.h"
+#include "Model.h"
+#include "ModelLoader.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+class CarResidency {
+public:
+    enum class State { Empty, Loading, Resident, Failed };
+
+    // Model wspólny dla stanowisk z tą samą ścieżką
+    struct Car {
+        std::string modelPath;
+        State state = State::Empty;
+        Model* model = nullptr;
+        bool visible = false;           // choć jedno stanowisko w frustumie w bieżącej klatce
+        uint64_t lastVisibleFrame = 0;
+        float distance = 0.0f;          // od kamery do najbliższego stanowiska (do sfery otaczającej)
+        int nearestVisibleSlot = -1;    // do wyboru LOD całej partii instancji
+
+        // AABB w przestrzeni modelu - zanim auto wczyta się pierwszy raz, typowe wymiary auta
+        glm::vec3 boundsMin = glm::vec3(-0.45f, -0.33f, -1.0f);
+        glm::vec3 boundsMax = glm::vec3( 0.45f,  0.33f,  1.0f);
+        glm::vec3 sphereCenter = glm::vec3(0.0f);
+        float sphereRadius = 1.15f;
+
+        // Ostatnio zmierzone zużycie pamięci (zostaje po zwolnieniu - szacunek przy ponownym wczytaniu)
+        size_t gpuBytes = 0;
+        size_t cpuBytes = 0;
+    };
+
+    // Stanowisko w salonie = jedna instancja modelu
+    struct Slot {
+        int car;                        // indeks w cars()
+        int paintLayer;                 // numer lakieru (car_paint_N = N-1), tekstura w TextureLibrary
+        glm::mat4 transform;            // model -> świat (pozycja stanowiska)
+        bool visible = false;
+        bool occluded = false;          // w frustumie, ale zasłonięte przez bliższe auta (updateOcclusion)
+        float distance = 0.0f;
+    };
+
+    // Auta bliżej niż tyle metrów od kamery są wczytywane
+    static constexpr float LOAD_RADIUS = 25.0f;
+    // Ile modeli naraz może być w drodze (import + upload)
+    static constexpr int MAX_IN_FLIGHT = 4;
+    // Ile najbliższych aut rysuje okluder do bufora głębokości
+    static constexpr size_t MAX_OCCLUDERS = 24;
+
+    CarResidency(ModelLoader &loader, size_t gpuBudget, size_t cpuBudget)
+        : loader(loader), gpuBudget(gpuBudget), cpuBudget(cpuBudget) {}
+
+    ~CarResidency() {
+        for(Car &car : carList)
+            if(car.state == State::Resident) delete car.model;
+    }
+
+    CarResidency(const CarResidency&) = delete;
+    CarResidency& operator=(const CarResidency&) = delete;
+
+    int addSlot(const std::string &modelPath, int paintLayer, const glm::mat4 &transform) {
+        Slot slot;
+        slot.car = -1;
+        for(size_t i = 0; i < carList.size(); i++)
+            if(carList[i].modelPath == modelPath) slot.car = static_cast<int>(i);
+        if(slot.car < 0) {
+            Car car;
+            car.modelPath = modelPath;
+            carList.push_back(car);
+            slot.car = static_cast<int>(carList.size()) - 1;
+        }
+        slot.paintLayer = paintLayer;
+        slot.transform = transform;
+        slotList.push_back(slot);
+        slotBounds.push_back(worldBounds(slot));
+        rebuildBvh = true;
+        return static_cast<int>(slotList.size()) - 1;
+    }
+
+    // Przestawienie auta - BVH dostaje refit w następnej klatce
+    void moveSlot(int index, const glm::mat4 &transform) {
+        Slot &slot = slotList[index];
+        slot.transform = transform;
+        slotBounds[index] = worldBounds(slot);
+        refitBvh = true;
+    }
+
+    // Stanowisko trafione promieniem (kierunek dowolnej długości) albo -1; distance w jednostkach kierunku.
+    // Wczytane auta: trójkąty siatek (TriangleBvh), pozostałe: pudełko pośrednika.
+    int pick(const glm::vec3 &origin, const glm::vec3 &direction, float &distance) {
+        syncBvh();
+        return slotBvh.raycast(origin, direction, distance, [&](uint32_t index, float maxT) {
+            const Slot &slot = slotList[index];
+            const Car &car = carList[slot.car];
+            // Ten sam parametr t w przestrzeni modelu, bo kierunek przekształcamy bez normalizacji
+            glm::mat4 toModel = glm::inverse(slot.transform);
+            glm::vec3 localOrigin = glm::vec3(toModel * glm::vec4(origin, 1.0f));
+            glm::vec3 localDirection = glm::vec3(toModel * glm::vec4(direction, 0.0f));
+            glm::vec3 invDirection = 1.0f / localDirection;
+            if(car.state != State::Resident)
+                return Aabb{ car.boundsMin, car.boundsMax }.intersect(localOrigin, invDirection, maxT);
+
+            float best = FLT_MAX;
+            for(const Mesh &mesh : car.model->meshes) {
+                if(Aabb{ mesh.boundsMin, mesh.boundsMax }.intersect(localOrigin, invDirection, std::min(best, maxT)) == FLT_MAX) continue;
+                float t = mesh.triangleBvh ? mesh.triangleBvh->raycast(localOrigin, localDirection)
+                                           : Aabb{ mesh.boundsMin, mesh.boundsMax }.intersect(localOrigin, invDirection, maxT);
+                best = std::min(best, t);
+            }
+            return best < maxT ? best : FLT_MAX;
+        });
+    }
+
+    // Stanowisko najbliższe punktowi (odległość do AABB w świecie) albo -1
+    int nearestSlot(const glm::vec3 &point, float &distance) {
+        syncBvh();
+        float distanceSquared;
+        int best = slotBvh.nearest(point, distanceSquared, [&](uint32_t index) { return slotBounds[index].distanceSquared(point); });
+        distance = std::sqrt(distanceSquared);
+        return best;
+    }
+
+    // Raz na klatkę, przed rysowaniem aut
+    void update(const glm::vec3 &cameraPos, const glm::mat4 &viewProjection, double uploadBudgetMs) {
+        frame++;
+        updateVisibility(cameraPos, viewProjection);
+
+        for(const ModelLoader::Finished &finished : loader.pump(uploadBudgetMs))
+            arrive(carList[finished.slot], finished.model);
+
+        measure();
+        requestNearby();
+        enforceBudget();
+    }
+
+    // Po update(): najbliższe wczytane auta jako okludery, potem test każdego widocznego stanowiska.
+    // Nie zmienia visible - zasłonięte auto zostaje w pamięci, tylko się nie rysuje.
+    void updateOcclusion(OcclusionCuller &occlusion, const glm::mat4 &viewProjection) {
+        occluderSlots.clear();
+        for(size_t i = 0; i < slotList.size(); i++) {
+            const Slot &slot = slotList[i];
+            const Car &car = carList[slot.car];
+            if(slot.visible && car.state == State::Resident && car.model->occluder.valid())
+                occluderSlots.push_back(static_cast<uint32_t>(i));
+        }
+        size_t occluderCount = std::min(occluderSlots.size(), MAX_OCCLUDERS);
+        std::partial_sort(occluderSlots.begin(), occluderSlots.begin() + occluderCount, occluderSlots.end(),
+                          [&](uint32_t a, uint32_t b) { return slotList[a].distance < slotList[b].distance; });
+
+        occlusion.begin(viewProjection);
+        for(size_t i = 0; i < occluderCount; i++) {
+            const Slot &slot = slotList[occluderSlots[i]];
+            occlusion.addOccluder(slot.transform, carList[slot.car].model->occluder);
+        }
+        occlusion.rasterize();
+
+        for(size_t i = 0; i < slotList.size(); i++) {
+            Slot &slot = slotList[i];
+            slot.occluded = slot.visible && !occlusion.visible(slotBounds[i]);
+        }
+    }
+
+    // Bez odrzucania zasłoniętych (wyłączone klawiszem)
+    void clearOcclusion() {
+        for(Slot &slot : slotList) slot.occluded = false;
+    }
+
+    std::vector<Slot>& slots() { return slotList; }
+    std::vector<Car>& cars() { return carList; }
+
+    size_t gpuBytes() const { return gpuUsed; }
+    size_t cpuBytes() const { return cpuUsed; }
+
+    // Odrzucenia stanowisk w ostatniej klatce (BVH + test SIMD stanowisk z liści przecinających frustum)
+    const FrustumCuller::Stats& cullStats() const { return visibilityStats; }
+    uint64_t bvhNodesVisited() const { return slotBvh.visitedNodes; }
+
+private:
+    ModelLoader &loader;
+    size_t gpuBudget;
+    size_t cpuBudget;
+
+    std::vector<Car> carList;
+    std::vector<Slot> slotList;
+    uint64_t frame = 0;
+    FrustumCuller culler;
+    FrustumCuller::Stats visibilityStats;
+    std::vector<Aabb> slotBounds; // AABB stanowisk w świecie, w kolejności slotList
+    Bvh slotBvh;
+    bool rebuildBvh = false;
+    bool refitBvh = false;
+    std::vector<uint32_t> partialSlots;
+    std::vector<uint32_t> occluderSlots;
+    size_t gpuUsed = 0;
+    size_t cpuUsed = 0;
+
+    glm::vec3 center(const Slot &slot) const {
+        const Car &car = carList[slot.car];
+        return glm::vec3(slot.transform * glm::vec4((car.boundsMin + car.boundsMax) * 0.5f, 1.0f));
+    }
+
+    Aabb worldBounds(const Slot &slot) const {
+        const Car &car = carList[slot.car];
+        return Aabb::transformed(slot.transform, car.boundsMin, car.boundsMax);
+    }
+
+    // Nowe stanowiska = przebudowa, zmienione pudełka = refit
+    void syncBvh() {
+        if(rebuildBvh) slotBvh.build(slotBounds);
+        else if(refitBvh) slotBvh.refit(slotBounds);
+        rebuildBvh = refitBvh = false;
+    }
+
+    float radius(const Slot &slot) const {
+        const Car &car = carList[slot.car];
+        float scale = glm::length(glm::vec3(slot.transform[0]));
+        return glm::length(car.boundsMax - car.boundsMin) * 0.5f * scale;
+    }
+
+    // Węzły BVH w całości we frustumie dają widoczne stanowiska bez testów; stanowiska z liści
+    // przecinających frustum sprawdza dokładniej (AABB + sfera modelu) jądro SIMD
+    void updateVisibility(const glm::vec3 &cameraPos, const glm::mat4 &viewProjection) {
+        auto start = std::chrono::steady_clock::now();
+        for(Car &car : carList) {
+            car.visible = false;
+            car.distance = std::numeric_limits<float>::max();
+            car.nearestVisibleSlot = -1;
+        }
+        for(Slot &slot : slotList) slot.visible = false;
+
+        syncBvh();
+        Frustum frustum = Frustum::fromMatrix(viewProjection);
+        partialSlots.clear();
+        slotBvh.frustum(frustum, [&](uint32_t index, bool partial) {
+            if(partial) partialSlots.push_back(index);
+            else slotList[index].visible = true;
+        });
+
+        culler.clear();
+        for(uint32_t index : partialSlots) {
+            const Slot &slot = slotList[index];
+            const Car &car = carList[slot.car];
+            culler.push(slot.transform, car.boundsMin, car.boundsMax, car.sphereCenter, car.sphereRadius);
+        }
+        culler.cull(frustum);
+        for(size_t i = 0; i < partialSlots.size(); i++)
+            slotList[partialSlots[i]].visible = culler.visible(i);
+
+        unsigned int visibleCount = 0;
+        for(size_t i = 0; i < slotList.size(); i++) {
+            Slot &slot = slotList[i];
+            Car &car = carList[slot.car];
+            slot.distance = std::max(glm::length(center(slot) - cameraPos) - radius(slot), 0.0f);
+            car.distance = std::min(car.distance, slot.distance);
+
+            if(!slot.visible) continue;
+            visibleCount++;
+            if(car.nearestVisibleSlot < 0 || slot.distance < slotList[car.nearestVisibleSlot].distance)
+                car.nearestVisibleSlot = static_cast<int>(i);
+            car.visible = true;
+            car.lastVisibleFrame = frame;
+        }
+
+        visibilityStats.tested = static_cast<unsigned int>(slotList.size());
+        visibilityStats.culled = static_cast<unsigned int>(slotList.size()) - visibleCount;
+        visibilityStats.microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void arrive(Car &car, Model* model) {
+        if(!model) {
+            car.state = State::Failed; // nie próbujemy w kółko
+            return;
+        }
+        car.model = model;
+        car.state = State::Resident;
+        car.lastVisibleFrame = frame;
+        model->bounds(car.boundsMin, car.boundsMax);
+        model->boundingSphere(car.sphereCenter, car.sphereRadius);
+
+        // Rzeczywiste wymiary auta zamiast typowych - pudełka jego stanowisk się zmieniają
+        for(size_t i = 0; i < slotList.size(); i++) {
+            if(&carList[slotList[i].car] != &car) continue;
+            slotBounds[i] = worldBounds(slotList[i]);
+            refitBvh = true;
+        }
+    }
+
+    void evict(Car &car) {
+        std::cout << "Zwolniono auto: " << car.modelPath << " (GPU " << car.gpuBytes / 1024 << " KB)" << std::endl;
+        delete car.model; // oddaje zakresy aren i tekstury materiałów
+        car.model = nullptr;
+        car.state = State::Empty;
+    }
+
+    // Tekstury dochodzą z opóźnieniem, więc zużycie liczymy co klatkę
+    void measure() {
+        gpuUsed = 0;
+        cpuUsed = 0;
+        for(Car &car : carList) {
+            if(car.state != State::Resident) continue;
+            car.gpuBytes = car.model->gpuBytes();
+            car.cpuBytes = car.model->cpuBytes();
+            gpuUsed += car.gpuBytes;
+            cpuUsed += car.cpuBytes;
+        }
+    }
+
+    // Model, który można zwolnić: wczytany i bez widocznych stanowisk; najdawniej widziany, potem najdalszy
+    Car* evictionCandidate() {
+        Car* best = nullptr;
+        for(Car &car : carList) {
+            if(car.state != State::Resident || car.visible) continue;
+            if(!best || car.lastVisibleFrame < best->lastVisibleFrame ||
+               (car.lastVisibleFrame == best->lastVisibleFrame && car.distance > best->distance))
+                best = &car;
+        }
+        return best;
+    }
+
+    bool overBudget(size_t extraGpu = 0, size_t extraCpu = 0) const {
+        return gpuUsed + extraGpu > gpuBudget || cpuUsed + extraCpu > cpuBudget;
+    }
+
+    void requestNearby() {
+        int inFlight = 0;
+        size_t knownGpu = 0, knownCpu = 0, known = 0;
+        std::vector<Car*> candidates;
+        for(Car &car : carList) {
+            if(car.state == State::Loading) inFlight++;
+            if(car.gpuBytes > 0) {
+                knownGpu += car.gpuBytes;
+                knownCpu += car.cpuBytes;
+                known++;
+            }
+            if(car.state == State::Empty && car.distance < LOAD_RADIUS)
+                candidates.push_back(&car);
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Car* a, const Car* b) {
+            if(a->visible != b->visible) return a->visible;
+            return a->distance < b->distance;
+        });
+
+        for(Car* car : candidates) {
+            if(inFlight >= MAX_IN_FLIGHT) break;
+            // Model niewidoczny ładujemy tylko do wolnego budżetu. Widoczny może wypchnąć
+            // niewidoczny - inaczej ten sam model byłby na zmianę wczytywany i zwalniany.
+            size_t expectedGpu = car->gpuBytes ? car->gpuBytes : (known ? knownGpu / known : 0);
+            size_t expectedCpu = car->cpuBytes ? car->cpuBytes : (known ? knownCpu / known : 0);
+            if(overBudget(expectedGpu, expectedCpu) && !(car->visible && evictionCandidate())) continue;
+
+            car->state = State::Loading;
+            loader.request(static_cast<int>(car - carList.data()), car->modelPath);
+            gpuUsed += expectedGpu; // rezerwacja do końca klatki
+            cpuUsed += expectedCpu;
+            inFlight++;
+        }
+    }
+
+    void enforceBudget() {
+        measure();
+        while(overBudget()) {
+            Car* victim = evictionCandidate();
+            if(!victim) break; // same widoczne modele - zostają, nowe poczekają jako pośredniki
+            gpuUsed -= victim->gpuBytes;
+            cpuUsed -= victim->cpuBytes;
+            evict(*victim);
+        }
+    }
+};
+
+#endif
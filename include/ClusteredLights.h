@@ -0,0 +1,305 @@
+#ifndef CLUSTERED_LIGHTS_H
+#define CLUSTERED_LIGHTS_H
+
+// Oświetlenie klastrowe (clustered forward): frustum kamery podzielone na TILES_X x TILES_Y kafli ekranu
+// i SLICES plastrów głębokości (logarytmicznie - bliskie plastry cienkie, dalekie grube). Co klatkę CPU
+// przypisuje światła do klastrów, a fragment shader liczy tylko światła swojego klastra - koszt piksela
+// zależy od świateł w pobliżu, nie od wszystkich reflektorów salonu.
+//
+//  - przypisanie: światło -> zakres plastrów i kafli (rzut pudełka kuli), potem test kula vs AABB klastra;
+//    plastry rozdaje licznik między wątek renderujący i wolne wątki puli (każdy plaster pisze tylko swoje klastry),
+//  - klaster ma co najwyżej MAX_LIGHTS_PER_CLUSTER świateł (nadmiar liczony w Stats::overflow),
+//  - wynik trafia na GPU jako bufory tekstur (GL_TEXTURE_BUFFER, rdzeń 3.1) - działa też na ścieżce GL 3.3:
+//      lightData   RGBA32F, 3 teksele na światło (Light bez zmian),
+//      clusterGrid RG32UI,  (początek, liczba) na klaster,
+//      lightIndices R16UI,  numery świateł kolejnych klastrów.
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "ThreadPool.h"
+#include "UniformBuffers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Światło w przestrzeni świata - układ taki jak 3 teksele RGBA32F w lightData (48 B)
+struct Light {
+    glm::vec3 position;
+    float     radius;    // zasięg: poza nim światło nie działa (okno wygaszania w shaderze)
+    glm::vec3 color;     // kolor razem z mocą
+    float     cosInner;  // reflektor: pełne światło wewnątrz tego kąta
+    glm::vec3 direction;
+    float     cosOuter;  // reflektor: ciemno poza tym kątem; punktowe: -2 (zawsze w stożku)
+
+    static Light point(const glm::vec3 &position, float radius, const glm::vec3 &color) {
+        return Light{ position, radius, color, -1.0f, glm::vec3(0.0f, -1.0f, 0.0f), -2.0f };
+    }
+
+    static Light spot(const glm::vec3 &position, const glm::vec3 &direction, float radius, const glm::vec3 &color, float innerDegrees, float outerDegrees) {
+        return Light{ position, radius, color, std::cos(glm::radians(innerDegrees)), glm::normalize(direction), std::cos(glm::radians(outerDegrees)) };
+    }
+};
+static_assert(sizeof(Light) == 48, "Light musi odpowiadac 3 tekselom RGBA32F w lightData");
+
+class ClusteredLights {
+public:
+    static constexpr int TILES_X = 16;
+    static constexpr int TILES_Y = 9;
+    static constexpr int SLICES = 24;
+    static constexpr int CLUSTERS = TILES_X * TILES_Y * SLICES;
+    static constexpr int MAX_LIGHTS_PER_CLUSTER = 32;
+    static constexpr int MAX_LIGHTS = 65535; // numer światła w R16UI
+    // Nazwy samplerów w shader.frag i ich jednostki (0..2 zajmuje TextureLibrary)
+    static constexpr const char* SAMPLERS[3] = { "lightData", "clusterGrid", "lightIndices" };
+    static constexpr int FIRST_UNIT = 3;
+
+    // Liczniki ostatniej klatki
+    struct Stats {
+        unsigned int lights = 0;
+        unsigned int visibleLights = 0;  // co najmniej jeden klaster
+        unsigned int references = 0;     // suma świateł po klastrach
+        unsigned int occupiedClusters = 0;
+        unsigned int maxPerCluster = 0;
+        unsigned int overflow = 0;       // pominięte przez MAX_LIGHTS_PER_CLUSTER
+        double assignMicroseconds = 0.0;
+    };
+
+    // pool == nullptr: wszystkie plastry na wątku wywołującym
+    explicit ClusteredLights(ThreadPool* pool = nullptr)
+        : pool(pool), counts(CLUSTERS, 0), slots(static_cast<size_t>(CLUSTERS) * MAX_LIGHTS_PER_CLUSTER), grid(CLUSTERS * 2, 0) {}
+
+    ~ClusteredLights() {
+        for(int i = 0; i < 3; i++) {
+            if(textures[i]) glDeleteTextures(1, &textures[i]);
+            if(buffers[i]) glDeleteBuffers(1, &buffers[i]);
+        }
+    }
+
+    ClusteredLights(const ClusteredLights&) = delete;
+    ClusteredLights& operator=(const ClusteredLights&) = delete;
+
+    // Światła sceny (stałe w świecie); wysyłane na GPU przy najbliższym upload()
+    void setLights(std::vector<Light> sceneLights) {
+        if(sceneLights.size() > MAX_LIGHTS) sceneLights.resize(MAX_LIGHTS);
+        lights = std::move(sceneLights);
+        lightsDirty = true;
+    }
+
+    const std::vector<Light>& sceneLights() const { return lights; }
+
+    // Przypisanie świateł do klastrów dla kamery (bez GL - działa też w benchmarku bez okna)
+    void assign(const glm::mat4 &view, float fovY, float aspect, float zNear, float zFar) {
+        auto start = std::chrono::steady_clock::now();
+        if(fovY != gridFov || aspect != gridAspect || zNear != gridNear || zFar != gridFar) buildBounds(fovY, aspect, zNear, zFar);
+
+        // Zakres klastrów każdego światła - raz, na wątku wywołującym
+        ranges.resize(lights.size());
+        for(size_t i = 0; i < lights.size(); i++) ranges[i] = rangeFor(view, lights[i]);
+
+        if(pool) pool->parallelFor(SLICES, [this](int slice) { assignSlice(slice); });
+        else for(int slice = 0; slice < SLICES; slice++) assignSlice(slice);
+
+        // Zwarta lista: (początek, liczba) na klaster + numery świateł po kolei
+        frameStats = Stats();
+        frameStats.lights = static_cast<unsigned int>(lights.size());
+        indices.clear();
+        for(int c = 0; c < CLUSTERS; c++) {
+            grid[c * 2] = static_cast<uint32_t>(indices.size());
+            grid[c * 2 + 1] = counts[c];
+            indices.insert(indices.end(), slots.begin() + static_cast<size_t>(c) * MAX_LIGHTS_PER_CLUSTER,
+                           slots.begin() + static_cast<size_t>(c) * MAX_LIGHTS_PER_CLUSTER + counts[c]);
+            frameStats.occupiedClusters += counts[c] ? 1 : 0;
+            frameStats.maxPerCluster = std::max(frameStats.maxPerCluster, counts[c]);
+        }
+        frameStats.references = static_cast<unsigned int>(indices.size());
+        for(const Range &range : ranges) frameStats.visibleLights += range.minSlice <= range.maxSlice ? 1 : 0;
+        for(int s = 0; s < SLICES; s++) frameStats.overflow += sliceOverflow[s];
+        frameStats.assignMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Skale klastra dla fragment shadera: kafel z gl_FragCoord, plaster z log(głębokości)
+    void fillFrame(FrameUniforms &frame, int viewportWidth, int viewportHeight) const {
+        float logRatio = std::log(gridFar / gridNear);
+        frame.clusterScale = glm::vec4(static_cast<float>(TILES_X) / viewportWidth, static_cast<float>(TILES_Y) / viewportHeight,
+                                       SLICES / logRatio, -SLICES * std::log(gridNear) / logRatio);
+        frame.clusterSize = glm::ivec4(TILES_X, TILES_Y, SLICES, static_cast<int>(lights.size()));
+    }
+
+    // Wymaga kontekstu GL: światła (gdy się zmieniły), siatka klastrów i lista numerów
+    void upload() {
+        if(!buffers[0]) createTextures();
+        if(lightsDirty) {
+            // Pusty bufor tekstury nie ma tekseli - zawsze co najmniej jedno (niewidoczne) światło
+            std::vector<Light> data = lights.empty() ? std::vector<Light>(1, Light::point(glm::vec3(0.0f), 0.0f, glm::vec3(0.0f))) : lights;
+            glBindBuffer(GL_TEXTURE_BUFFER, buffers[0]);
+            glBufferData(GL_TEXTURE_BUFFER, data.size() * sizeof(Light), data.data(), GL_STATIC_DRAW);
+            lightsDirty = false;
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[1]);
+        glBufferData(GL_TEXTURE_BUFFER, grid.size() * sizeof(uint32_t), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, grid.size() * sizeof(uint32_t), grid.data());
+
+        if(indices.empty()) indices.push_back(0);
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[2]);
+        glBufferData(GL_TEXTURE_BUFFER, indices.size() * sizeof(uint16_t), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, indices.size() * sizeof(uint16_t), indices.data());
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    // Raz na klatkę: trzy bufory na jednostki FIRST_UNIT..FIRST_UNIT+2
+    void bind() const {
+        for(int i = 0; i < 3; i++) {
+            glActiveTexture(GL_TEXTURE0 + FIRST_UNIT + i);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+        }
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    const Stats& stats() const { return frameStats; }
+    uint32_t clusterCount(int cluster) const { return grid[cluster * 2 + 1]; }
+    const uint16_t* clusterLights(int cluster) const { return indices.data() + grid[cluster * 2]; }
+
+    static int clusterIndex(int x, int y, int slice) { return (slice * TILES_Y + y) * TILES_X + x; }
+
+private:
+    // Światło w przestrzeni widoku + klastry, które może dotknąć (minSlice > maxSlice = poza frustumem)
+    struct Range {
+        glm::vec3 center;
+        float radius;
+        int minX, maxX, minY, maxY, minSlice, maxSlice;
+    };
+
+    struct Bounds {
+        glm::vec3 min, max;
+    };
+
+    ThreadPool* pool;
+    std::vector<Light> lights;
+    std::vector<Range> ranges;
+    std::vector<Bounds> bounds;      // AABB klastrów w przestrzeni widoku (zależą tylko od projekcji)
+    std::vector<uint32_t> counts;    // liczba świateł klastra w tej klatce
+    std::vector<uint16_t> slots;     // MAX_LIGHTS_PER_CLUSTER miejsc na klaster
+    std::vector<uint32_t> grid;      // (początek, liczba) na klaster - treść clusterGrid
+    std::vector<uint16_t> indices;   // treść lightIndices
+    unsigned int sliceOverflow[SLICES] = {};
+    Stats frameStats;
+    float gridFov = 0.0f, gridAspect = 0.0f, gridNear = 0.1f, gridFar = 100.0f;
+    float tanHalfY = 0.0f, tanHalfX = 0.0f;
+
+    GLuint buffers[3] = { 0, 0, 0 };
+    GLuint textures[3] = { 0, 0, 0 };
+    bool lightsDirty = true;
+
+    // Granica plastra: głębokość near * (far / near)^(s / SLICES)
+    float sliceDepth(int slice) const { return gridNear * std::pow(gridFar / gridNear, static_cast<float>(slice) / SLICES); }
+
+    int sliceFor(float depth) const {
+        if(depth <= gridNear) return 0;
+        int slice = static_cast<int>(std::floor(std::log(depth / gridNear) / std::log(gridFar / gridNear) * SLICES));
+        return std::min(std::max(slice, 0), SLICES - 1);
+    }
+
+    void buildBounds(float fovY, float aspect, float zNear, float zFar) {
+        gridFov = fovY;
+        gridAspect = aspect;
+        gridNear = zNear;
+        gridFar = zFar;
+        tanHalfY = std::tan(fovY * 0.5f);
+        tanHalfX = tanHalfY * aspect;
+        bounds.resize(CLUSTERS);
+        for(int s = 0; s < SLICES; s++) {
+            float depthMin = sliceDepth(s), depthMax = sliceDepth(s + 1);
+            for(int y = 0; y < TILES_Y; y++) {
+                float ndcY0 = -1.0f + 2.0f * y / TILES_Y, ndcY1 = -1.0f + 2.0f * (y + 1) / TILES_Y;
+                for(int x = 0; x < TILES_X; x++) {
+                    float ndcX0 = -1.0f + 2.0f * x / TILES_X, ndcX1 = -1.0f + 2.0f * (x + 1) / TILES_X;
+                    // Ścięty ostrosłup klastra zamknięty w pudełku: narożniki na obu głębokościach (widok patrzy w -Z)
+                    Bounds box{ glm::vec3(1e30f), glm::vec3(-1e30f) };
+                    for(float depth : { depthMin, depthMax })
+                        for(float ndcX : { ndcX0, ndcX1 })
+                            for(float ndcY : { ndcY0, ndcY1 }) {
+                                glm::vec3 corner(ndcX * tanHalfX * depth, ndcY * tanHalfY * depth, -depth);
+                                box.min = glm::min(box.min, corner);
+                                box.max = glm::max(box.max, corner);
+                            }
+                    bounds[clusterIndex(x, y, s)] = box;
+                }
+            }
+        }
+    }
+
+    // Zakres kafli z rzutu pudełka kuli: x / głębokość jest monotoniczne w obu zmiennych, więc skrajne
+    // wartości leżą w narożnikach pudełka (głębokość przycięta do near - bliżej nic nie jest rysowane)
+    Range rangeFor(const glm::mat4 &view, const Light &light) const {
+        Range range;
+        range.center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+        range.radius = light.radius;
+        float depth = -range.center.z;
+        range.minSlice = 1;
+        range.maxSlice = 0;
+        if(depth + light.radius < gridNear || depth - light.radius > gridFar || light.radius <= 0.0f) return range;
+
+        float depthMin = std::max(depth - light.radius, gridNear), depthMax = std::min(depth + light.radius, gridFar);
+        auto tileRange = [&](float centerCoord, float tanHalf, int tiles, int &minTile, int &maxTile) {
+            float lo = 1e30f, hi = -1e30f;
+            for(float coord : { centerCoord - light.radius, centerCoord + light.radius })
+                for(float d : { depthMin, depthMax }) {
+                    float ndc = coord / (d * tanHalf);
+                    lo = std::min(lo, ndc);
+                    hi = std::max(hi, ndc);
+                }
+            minTile = std::max(0, static_cast<int>(std::floor((lo + 1.0f) * 0.5f * tiles)));
+            maxTile = std::min(tiles - 1, static_cast<int>(std::floor((hi + 1.0f) * 0.5f * tiles)));
+        };
+        tileRange(range.center.x, tanHalfX, TILES_X, range.minX, range.maxX);
+        tileRange(range.center.y, tanHalfY, TILES_Y, range.minY, range.maxY);
+        if(range.minX > range.maxX || range.minY > range.maxY) return range;
+        range.minSlice = sliceFor(depthMin);
+        range.maxSlice = sliceFor(depthMax);
+        return range;
+    }
+
+    // Plaster pisze tylko swoje klastry - wątki się nie nakładają
+    void assignSlice(int slice) {
+        int first = clusterIndex(0, 0, slice);
+        std::fill(counts.begin() + first, counts.begin() + first + TILES_X * TILES_Y, 0u);
+        unsigned int overflow = 0;
+        for(size_t i = 0; i < ranges.size(); i++) {
+            const Range &range = ranges[i];
+            if(slice < range.minSlice || slice > range.maxSlice) continue;
+            float radiusSquared = range.radius * range.radius;
+            for(int y = range.minY; y <= range.maxY; y++)
+                for(int x = range.minX; x <= range.maxX; x++) {
+                    int cluster = clusterIndex(x, y, slice);
+                    const Bounds &box = bounds[cluster];
+                    glm::vec3 closest = glm::clamp(range.center, box.min, box.max);
+                    glm::vec3 offset = closest - range.center;
+                    if(glm::dot(offset, offset) > radiusSquared) continue;
+                    uint32_t &count = counts[cluster];
+                    if(count < MAX_LIGHTS_PER_CLUSTER) slots[static_cast<size_t>(cluster) * MAX_LIGHTS_PER_CLUSTER + count++] = static_cast<uint16_t>(i);
+                    else overflow++;
+                }
+        }
+        sliceOverflow[slice] = overflow;
+    }
+
+    void createTextures() {
+        const GLenum formats[3] = { GL_RGBA32F, GL_RG32UI, GL_R16UI };
+        glGenBuffers(3, buffers);
+        glGenTextures(3, textures);
+        for(int i = 0; i < 3; i++) {
+            glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+            glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+            glTexBuffer(GL_TEXTURE_BUFFER, formats[i], buffers[i]);
+        }
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+};
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef FRUSTUM_CULLER_H
+#define FRUSTUM_CULLER_H
+
+// Odrzucanie obiektów poza frustumem kamery.
+// Obiekty są zbierane w tablicach SoA (osobno x, y, z środka, półwymiary AABB w świecie, promień sfery),
+// a jądro SSE testuje 4 obiekty naraz względem 6 płaszczyzn. Obiekt jest poza frustumem, gdy dla
+// którejś płaszczyzny zarówno AABB, jak i sfera leżą w całości po jej ujemnej stronie - bierzemy
+// ciaśniejszą z dwóch brył (min promieni), więc test jest konserwatywny dla obu.
+
+#include <glm/glm.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FRUSTUM_CULLER_SSE 1
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Płaszczyzny (nx, ny, nz, w) wyciągnięte z macierzy view-projection, znormalizowane, normalne do środka
+struct Frustum {
+    glm::vec4 planes[6];
+
+    static Frustum fromMatrix(const glm::mat4 &viewProjection) {
+        glm::mat4 m = glm::transpose(viewProjection);
+        Frustum frustum = { { m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2] } };
+        for(glm::vec4 &plane : frustum.planes) plane /= glm::length(glm::vec3(plane));
+        return frustum;
+    }
+};
+
+class FrustumCuller {
+public:
+    // Liczniki ostatniego cull()
+    struct Stats {
+        unsigned int tested = 0;
+        unsigned int culled = 0;
+        double microseconds = 0.0;
+    };
+
+    void clear() {
+        count = 0;
+        centerX.clear(); centerY.clear(); centerZ.clear();
+        extentX.clear(); extentY.clear(); extentZ.clear();
+        radii.clear();
+    }
+
+    // Bryły w przestrzeni modelu (AABB + sfera) przekształcone macierzą model -> świat; zwraca numer obiektu
+    size_t push(const glm::mat4 &transform, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax,
+                const glm::vec3 &sphereCenter, float sphereRadius) {
+        // AABB w świecie: środek przekształcony, półwymiary przez |M| (Arvo)
+        glm::vec3 center = glm::vec3(transform * glm::vec4((boundsMin + boundsMax) * 0.5f, 1.0f));
+        glm::vec3 half = (boundsMax - boundsMin) * 0.5f;
+        glm::vec3 extent = glm::abs(glm::vec3(transform[0])) * half.x +
+                           glm::abs(glm::vec3(transform[1])) * half.y +
+                           glm::abs(glm::vec3(transform[2])) * half.z;
+
+        // Sfera: jej środek w ogólności nie pokrywa się ze środkiem AABB, więc rozszerzamy promień o przesunięcie
+        float scale = std::max(glm::length(glm::vec3(transform[0])),
+                      std::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+        glm::vec3 worldSphere = glm::vec3(transform * glm::vec4(sphereCenter, 1.0f));
+        float radius = sphereRadius * scale + glm::length(worldSphere - center);
+
+        centerX.push_back(center.x); centerY.push_back(center.y); centerZ.push_back(center.z);
+        extentX.push_back(extent.x); extentY.push_back(extent.y); extentZ.push_back(extent.z);
+        radii.push_back(radius);
+        return count++;
+    }
+
+    // Wynik: visible(i) dla każdego obiektu od ostatniego clear()
+    void cull(const Frustum &frustum) {
+        auto start = std::chrono::steady_clock::now();
+
+        // Dopełnienie do wielokrotności 4 (jądro SSE czyta pełne czwórki)
+        size_t padded = (count + 3) & ~size_t(3);
+        for(std::vector<float>* column : { &centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ, &radii })
+            column->resize(padded, 0.0f);
+        visibility.assign(padded, 0);
+
+#ifdef FRUSTUM_CULLER_SSE
+        cullSse(frustum, padded);
+#else
+        cullScalar(frustum, padded);
+#endif
+        lastStats.tested = static_cast<unsigned int>(count);
+        lastStats.culled = 0;
+        for(size_t i = 0; i < count; i++) lastStats.culled += visibility[i] ? 0 : 1;
+        lastStats.microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        for(std::vector<float>* column : { &centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ, &radii })
+            column->resize(count);
+    }
+
+    bool visible(size_t i) const { return visibility[i] != 0; }
+    size_t size() const { return count; }
+    const Stats& stats() const { return lastStats; }
+
+private:
+    size_t count = 0;
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+    std::vector<float> radii;
+    std::vector<uint8_t> visibility;
+    Stats lastStats;
+
+    // Wersja referencyjna (bez SIMD) - do porównania wyników i czasu
+    void cullScalar(const Frustum &frustum, size_t n) {
+        for(size_t i = 0; i < n; i++) {
+            bool inside = true;
+            for(const glm::vec4 &plane : frustum.planes) {
+                float distance = plane.x * centerX[i] + plane.y * centerY[i] + plane.z * centerZ[i] + plane.w;
+                float boxRadius = std::abs(plane.x) * extentX[i] + std::abs(plane.y) * extentY[i] + std::abs(plane.z) * extentZ[i];
+                if(distance < -std::min(boxRadius, radii[i])) {
+                    inside = false;
+                    break;
+                }
+            }
+            visibility[i] = inside ? 1 : 0;
+        }
+    }
+
+#ifdef FRUSTUM_CULLER_SSE
+    void cullSse(const Frustum &frustum, size_t n) {
+        __m128 nx[6], ny[6], nz[6], nw[6], ax[6], ay[6], az[6];
+        for(int p = 0; p < 6; p++) {
+            const glm::vec4 &plane = frustum.planes[p];
+            nx[p] = _mm_set1_ps(plane.x); ny[p] = _mm_set1_ps(plane.y);
+            nz[p] = _mm_set1_ps(plane.z); nw[p] = _mm_set1_ps(plane.w);
+            ax[p] = _mm_set1_ps(std::abs(plane.x)); ay[p] = _mm_set1_ps(std::abs(plane.y));
+            az[p] = _mm_set1_ps(std::abs(plane.z));
+        }
+        const __m128 zero = _mm_setzero_ps();
+
+        for(size_t i = 0; i < n; i += 4) {
+            __m128 cx = _mm_loadu_ps(&centerX[i]), cy = _mm_loadu_ps(&centerY[i]), cz = _mm_loadu_ps(&centerZ[i]);
+            __m128 ex = _mm_loadu_ps(&extentX[i]), ey = _mm_loadu_ps(&extentY[i]), ez = _mm_loadu_ps(&extentZ[i]);
+            __m128 r = _mm_loadu_ps(&radii[i]);
+
+            __m128 outside = zero;
+            for(int p = 0; p < 6; p++) {
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], cx), _mm_mul_ps(ny[p], cy)),
+                                             _mm_add_ps(_mm_mul_ps(nz[p], cz), nw[p]));
+                __m128 boxRadius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)), _mm_mul_ps(az[p], ez));
+                __m128 limit = _mm_sub_ps(zero, _mm_min_ps(boxRadius, r));
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, limit));
+            }
+            int mask = _mm_movemask_ps(outside);
+            visibility[i]     = (mask & 1) ? 0 : 1;
+            visibility[i + 1] = (mask & 2) ? 0 : 1;
+            visibility[i + 2] = (mask & 4) ? 0 : 1;
+            visibility[i + 3] = (mask & 8) ? 0 : 1;
+        }
+    }
+#endif
+};
+
+#endif
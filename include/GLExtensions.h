@@ -0,0 +1,115 @@
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+// glad jest wygenerowany dla czystego core 3.3 bez rozszerzeń,
+// więc stałe i sprawdzanie rozszerzeń dopisujemy tutaj ręcznie.
+
+#include <glad/glad.h>
+#include <GL/freeglut.h>
+
+#include <cstring>
+#include <string>
+#include <unordered_set>
+
+// GL_EXT_texture_compression_s3tc
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT  0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+// Lista rozszerzeń kontekstu, pobierana raz (wymaga bieżącego kontekstu GL)
+inline bool hasGLExtension(const char* name) {
+    static std::unordered_set<std::string> extensions;
+    static bool queried = false;
+    if(!queried) {
+        queried = true;
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for(GLint i = 0; i < count; i++) {
+            const char* ext = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if(ext) extensions.insert(ext);
+        }
+    }
+    return extensions.count(name) != 0;
+}
+
+// Wersja kontekstu (GLUT bez glutInitContextVersion daje najwyższą dostępną)
+inline bool hasGLVersion(int major, int minor) {
+    GLint contextMajor = 0, contextMinor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &contextMajor);
+    glGetIntegerv(GL_MINOR_VERSION, &contextMinor);
+    return contextMajor > major || (contextMajor == major && contextMinor >= minor);
+}
+
+// --- GL 4.3: rysowanie pośrednie (glMultiDrawElementsIndirect) i bufory SSBO ---
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER  0x8F3F
+#endif
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+
+typedef void (APIENTRYP PFN_MultiDrawElementsIndirect)(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount, GLsizei stride);
+inline PFN_MultiDrawElementsIndirect glMultiDrawElementsIndirectProc = nullptr;
+
+// Funkcje spoza glad pobieramy przez GLUT; false = kontekst poniżej 4.3 (zostaje ścieżka 3.3)
+inline bool loadMultiDrawIndirect() {
+    if(!hasGLVersion(4, 3)) return false;
+    glMultiDrawElementsIndirectProc = reinterpret_cast<PFN_MultiDrawElementsIndirect>(glutGetProcAddress("glMultiDrawElementsIndirect"));
+    return glMultiDrawElementsIndirectProc != nullptr;
+}
+
+// --- GL 4.1 / ARB_get_program_binary: zapis i odczyt zlinkowanych programów (ProgramCache.h) ---
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH           0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS      0x87FE
+#endif
+
+typedef void (APIENTRYP PFN_GetProgramBinary)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP PFN_ProgramBinary)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP PFN_ProgramParameteri)(GLuint program, GLenum pname, GLint value);
+inline PFN_GetProgramBinary glGetProgramBinaryProc = nullptr;
+inline PFN_ProgramBinary glProgramBinaryProc = nullptr;
+inline PFN_ProgramParameteri glProgramParameteriProc = nullptr;
+
+// false = brak rozszerzenia albo sterownik nie ma żadnego formatu binarnego (np. część Mesa)
+inline bool loadProgramBinary() {
+    if(!hasGLVersion(4, 1) && !hasGLExtension("GL_ARB_get_program_binary")) return false;
+    glGetProgramBinaryProc = reinterpret_cast<PFN_GetProgramBinary>(glutGetProcAddress("glGetProgramBinary"));
+    glProgramBinaryProc = reinterpret_cast<PFN_ProgramBinary>(glutGetProcAddress("glProgramBinary"));
+    glProgramParameteriProc = reinterpret_cast<PFN_ProgramParameteri>(glutGetProcAddress("glProgramParameteri"));
+    if(!glGetProgramBinaryProc || !glProgramBinaryProc || !glProgramParameteriProc) return false;
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+// --- KHR/ARB_parallel_shader_compile: kompilacja w wątkach sterownika, stan bez blokowania ---
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef void (APIENTRYP PFN_MaxShaderCompilerThreads)(GLuint count);
+// true = GL_COMPLETION_STATUS_KHR można odpytywać (Shader::ready), bez tego zapytanie o stan czeka na kompilację
+inline bool parallelShaderCompile = false;
+
+inline bool loadParallelShaderCompile() {
+    PFN_MaxShaderCompilerThreads maxThreads = nullptr;
+    if(hasGLExtension("GL_KHR_parallel_shader_compile"))
+        maxThreads = reinterpret_cast<PFN_MaxShaderCompilerThreads>(glutGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+    else if(hasGLExtension("GL_ARB_parallel_shader_compile"))
+        maxThreads = reinterpret_cast<PFN_MaxShaderCompilerThreads>(glutGetProcAddress("glMaxShaderCompilerThreadsARB"));
+    if(!maxThreads) return false;
+    maxThreads(0xFFFFFFFFu); // liczbę wątków wybiera sterownik
+    parallelShaderCompile = true;
+    return true;
+}
+
+#endif
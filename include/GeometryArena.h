@@ -0,0 +1,382 @@
+#ifndef GEOMETRY_ARENA_H
+#define GEOMETRY_ARENA_H
+
+// Wspólne bufory geometrii dla wszystkich siatek wszystkich modeli:
+//  - jeden VBO + EBO + VAO na format wierzchołka (Vertex / PackedVertex),
+//  - siatki dostają podzakresy (baseVertex + offset indeksów) i rysują przez glDrawElementsBaseVertex,
+//  - zwolnienie auta oddaje zakresy; przy fragmentacji arena kompaktuje się kopią GPU->GPU.
+
+#include <glad/glad.h>
+
+#include "Vertex.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <vector>
+
+// Komenda glMultiDrawElementsIndirect (GL 4.3) - zakres siatki w arenie + partia instancji
+struct DrawElementsIndirectCommand {
+    uint32_t count;
+    uint32_t instanceCount;
+    uint32_t firstIndex;     // w elementach, nie w bajtach
+    int32_t  baseVertex;
+    uint32_t baseInstance;
+};
+
+// Przydział zakresów [offset, offset + size) z listy wolnych bloków (first fit)
+class RangeAllocator {
+public:
+    void reset(size_t newCapacity) {
+        freeBlocks.clear();
+        capacity = newCapacity;
+        used = 0;
+        if(capacity > 0) freeBlocks[0] = capacity;
+    }
+
+    bool allocate(size_t size, size_t alignment, size_t &offset) {
+        for(auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it) {
+            size_t blockStart = it->first, blockEnd = it->first + it->second;
+            size_t start = (blockStart + alignment - 1) / alignment * alignment;
+            if(start + size > blockEnd) continue;
+
+            freeBlocks.erase(it);
+            if(start > blockStart) freeBlocks[blockStart] = start - blockStart;
+            if(start + size < blockEnd) freeBlocks[start + size] = blockEnd - (start + size);
+            offset = start;
+            used += size;
+            return true;
+        }
+        return false;
+    }
+
+    void release(size_t offset, size_t size) {
+        used -= size;
+        auto it = freeBlocks.emplace(offset, size).first;
+        // Scalanie z następnym i poprzednim wolnym blokiem
+        auto next = std::next(it);
+        if(next != freeBlocks.end() && it->first + it->second == next->first) {
+            it->second += next->second;
+            freeBlocks.erase(next);
+        }
+        if(it != freeBlocks.begin()) {
+            auto prev = std::prev(it);
+            if(prev->first + prev->second == it->first) {
+                prev->second += it->second;
+                freeBlocks.erase(it);
+            }
+        }
+    }
+
+    size_t largestFree() const {
+        size_t largest = 0;
+        for(const auto &block : freeBlocks) largest = std::max(largest, block.second);
+        return largest;
+    }
+
+    size_t capacityUnits() const { return capacity; }
+    size_t usedUnits() const { return used; }
+
+private:
+    std::map<size_t, size_t> freeBlocks; // offset -> rozmiar
+    size_t capacity = 0;
+    size_t used = 0;
+};
+
+enum class VertexFormat { Full = 0, Packed = 1 };
+
+class GeometryArena {
+public:
+    // Podzakres jednej siatki. Po kompaktowaniu offsety się zmieniają, uchwyt zostaje.
+    struct Range {
+        size_t baseVertex = 0;
+        size_t vertexCount = 0;
+        size_t indexOffset = 0; // w bajtach
+        size_t indexBytes = 0;
+        bool live = false;
+    };
+
+    // Początkowa pojemność - potem podwajanie
+    static constexpr size_t INITIAL_VERTICES = 256 * 1024;
+    static constexpr size_t INITIAL_INDEX_BYTES = 4 * 1024 * 1024;
+
+    static GeometryArena& get(VertexFormat format) {
+        GeometryArena*& arena = arenas()[static_cast<int>(format)];
+        if(!arena) arena = new GeometryArena(format);
+        return *arena;
+    }
+
+    static void releaseAll() {
+        for(GeometryArena*& arena : arenas()) {
+            delete arena;
+            arena = nullptr;
+        }
+    }
+
+    // Bind z pamięcią ostatniego VAO - kolejne siatki z tej samej areny nic nie przełączają; true = był bind
+    static bool bindVertexArray(GLuint vao) {
+        if(boundVertexArray() == vao) return false;
+        glBindVertexArray(vao);
+        boundVertexArray() = vao;
+        return true;
+    }
+
+    // Kompaktuje areny, w których wolne miejsce jest mocno poszatkowane (np. po zwolnieniu auta)
+    static void compactFragmented() {
+        for(GeometryArena* arena : arenas())
+            if(arena && arena->isFragmented()) arena->compact();
+    }
+
+    ~GeometryArena() {
+        if(VAO) glDeleteVertexArrays(1, &VAO);
+        if(VBO) glDeleteBuffers(1, &VBO);
+        if(EBO) glDeleteBuffers(1, &EBO);
+        if(boundVertexArray() == VAO) boundVertexArray() = 0;
+    }
+
+    GeometryArena(const GeometryArena&) = delete;
+    GeometryArena& operator=(const GeometryArena&) = delete;
+
+    // Zwraca uchwyt zakresu; dane lecą od razu do wspólnych buforów
+    unsigned int allocate(const void* vertexData, size_t vertexCount, const void* indexData, size_t indexBytes) {
+        Range range;
+        if(!tryAllocate(vertexCount, indexBytes, range)) {
+            // Najpierw kompaktowanie, a jeśli to za mało - większe bufory. Zakresy indeksów zaczynają się
+            // na granicy 4 B, więc potrzebne miejsce to suma rozmiarów dopełnionych do 4 (usedUnits() ich nie dopełnia)
+            size_t vertexCapacity = std::max(vertexAllocator.capacityUnits(), INITIAL_VERTICES);
+            size_t indexCapacity = std::max(indexAllocator.capacityUnits(), INITIAL_INDEX_BYTES);
+            size_t paddedIndexBytes = padTo4(indexBytes);
+            for(const Range &live : ranges)
+                if(live.live) paddedIndexBytes += padTo4(live.indexBytes);
+            while(vertexCapacity < vertexAllocator.usedUnits() + vertexCount) vertexCapacity *= 2;
+            while(indexCapacity < paddedIndexBytes) indexCapacity *= 2;
+            // Po ciasnym ułożeniu nowa siatka zawsze się mieści; gdyby nie - kolejne podwojenie zamiast zapisu w cudzy zakres
+            while(!rebuild(vertexCapacity, indexCapacity) || !tryAllocate(vertexCount, indexBytes, range)) {
+                vertexCapacity *= 2;
+                indexCapacity *= 2;
+            }
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferSubData(GL_ARRAY_BUFFER, range.baseVertex * stride, vertexCount * stride, vertexData);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, EBO); // EBO bez VAO - nie ruszamy stanu VAO
+        glBufferSubData(GL_COPY_WRITE_BUFFER, range.indexOffset, indexBytes, indexData);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        unsigned int handle;
+        if(!freeHandles.empty()) {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+            ranges[handle] = range;
+        } else {
+            handle = static_cast<unsigned int>(ranges.size());
+            ranges.push_back(range);
+        }
+        return handle;
+    }
+
+    void release(unsigned int handle) {
+        Range &range = ranges[handle];
+        if(!range.live) return;
+        vertexAllocator.release(range.baseVertex, range.vertexCount);
+        indexAllocator.release(range.indexOffset, range.indexBytes);
+        range.live = false;
+        freeHandles.push_back(handle);
+    }
+
+    // Przesuwa wszystkie żywe zakresy na początek buforów (ta sama pojemność)
+    void compact() {
+        if(vertexAllocator.capacityUnits() == 0) return;
+        size_t before = vertexAllocator.largestFree();
+        // Ciasne ułożenie w tej samej pojemności może nie wyjść o kilka bajtów dopełnienia - wtedy układ zostaje
+        if(!rebuild(vertexAllocator.capacityUnits(), indexAllocator.capacityUnits())) return;
+        std::cout << "Arena geometrii: kompaktowanie, najwiekszy wolny blok " << before
+                  << " -> " << vertexAllocator.largestFree() << " wierzcholkow" << std::endl;
+    }
+
+    bool isFragmented() const {
+        size_t freeVertices = vertexAllocator.capacityUnits() - vertexAllocator.usedUnits();
+        return freeVertices > 0 && vertexAllocator.largestFree() < freeVertices / 2;
+    }
+
+    const Range& range(unsigned int handle) const { return ranges[handle]; }
+
+    void bind() const { bindVertexArray(VAO); }
+    GLuint vertexArray() const { return VAO; }
+
+    // Atrybuty instancji (4-11) wskazują na InstanceData od "offset" w buforze instancji.
+    // GL 3.3 nie ma baseInstance, więc każda partia instancji przestawia wskaźniki; true = była zmiana.
+    bool bindInstances(GLuint buffer, size_t offset) {
+        if(instanceBuffer == buffer && instanceOffset == offset) return false;
+        bindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        for(GLuint column = 0; column < 4; column++) {
+            glEnableVertexAttribArray(4 + column);
+            glVertexAttribPointer(4 + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                                  (void*)(offset + offsetof(InstanceData, Transform) + column * sizeof(glm::vec4)));
+            glVertexAttribDivisor(4 + column, 1);
+        }
+        glEnableVertexAttribArray(8);
+        glVertexAttribPointer(8, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offset + offsetof(InstanceData, PaintLayer)));
+        glVertexAttribDivisor(8, 1);
+        for(GLuint column = 0; column < 3; column++) {
+            glEnableVertexAttribArray(9 + column);
+            glVertexAttribPointer(9 + column, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                                  (void*)(offset + offsetof(InstanceData, NormalMatrix) + column * sizeof(glm::vec4)));
+            glVertexAttribDivisor(9 + column, 1);
+        }
+        instanceBuffer = buffer;
+        instanceOffset = offset;
+        return true;
+    }
+
+    // Ścieżka pośrednia (IndirectDraw.h): atrybut 12 = numer rysowania, stały w całej komendzie
+    void bindDrawIds(GLuint buffer, GLuint divisor) {
+        if(drawIdBuffer == buffer) return;
+        bindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glEnableVertexAttribArray(12);
+        glVertexAttribIPointer(12, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void*)0);
+        glVertexAttribDivisor(12, divisor);
+        drawIdBuffer = buffer;
+    }
+
+    size_t gpuBytes() const { return vertexAllocator.capacityUnits() * stride + indexAllocator.capacityUnits(); }
+
+private:
+    VertexFormat format;
+    size_t stride;
+    GLuint VAO = 0, VBO = 0, EBO = 0;
+    GLuint instanceBuffer = 0;  // ostatnie bindInstances
+    size_t instanceOffset = 0;
+    GLuint drawIdBuffer = 0;    // ostatnie bindDrawIds
+
+    RangeAllocator vertexAllocator; // w wierzchołkach
+    RangeAllocator indexAllocator;  // w bajtach (mieszane indeksy 16/32-bit, wyrównanie 4)
+    std::vector<Range> ranges;
+    std::vector<unsigned int> freeHandles;
+
+    static std::array<GeometryArena*, 2>& arenas() {
+        static std::array<GeometryArena*, 2> instances = { nullptr, nullptr };
+        return instances;
+    }
+
+    static GLuint& boundVertexArray() {
+        static GLuint bound = 0;
+        return bound;
+    }
+
+    explicit GeometryArena(VertexFormat format) : format(format) {
+        stride = format == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(Vertex);
+        glGenVertexArrays(1, &VAO);
+    }
+
+    static size_t padTo4(size_t bytes) { return (bytes + 3) / 4 * 4; }
+
+    bool tryAllocate(size_t vertexCount, size_t indexBytes, Range &range) {
+        size_t baseVertex, indexOffset;
+        if(!vertexAllocator.allocate(vertexCount, 1, baseVertex)) return false;
+        if(!indexAllocator.allocate(indexBytes, 4, indexOffset)) {
+            vertexAllocator.release(baseVertex, vertexCount);
+            return false;
+        }
+        range.baseVertex = baseVertex;
+        range.vertexCount = vertexCount;
+        range.indexOffset = indexOffset;
+        range.indexBytes = indexBytes;
+        range.live = true;
+        return true;
+    }
+
+    // Nowe bufory o zadanej pojemności, żywe zakresy kopiowane ciasno na początek (GPU->GPU).
+    // Najpierw samo rozmieszczenie - false = zakresy się nie mieszczą, bufory i przydziały bez zmian.
+    bool rebuild(size_t vertexCapacity, size_t indexCapacity) {
+        RangeAllocator vertices, indices;
+        vertices.reset(vertexCapacity);
+        indices.reset(indexCapacity);
+        std::vector<Range> placed(ranges.size());
+        for(size_t i = 0; i < ranges.size(); i++) {
+            if(!ranges[i].live) continue;
+            if(!vertices.allocate(ranges[i].vertexCount, 1, placed[i].baseVertex) ||
+               !indices.allocate(ranges[i].indexBytes, 4, placed[i].indexOffset)) {
+                std::cout << "Arena geometrii: zakresy nie mieszcza sie w " << vertexCapacity << " wierzcholkach / "
+                          << indexCapacity << " B indeksow" << std::endl;
+                return false;
+            }
+        }
+
+        GLuint newVBO, newEBO;
+        glGenBuffers(1, &newVBO);
+        glGenBuffers(1, &newEBO);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newVBO);
+        glBufferData(GL_COPY_WRITE_BUFFER, vertexCapacity * stride, NULL, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newEBO);
+        glBufferData(GL_COPY_WRITE_BUFFER, indexCapacity, NULL, GL_STATIC_DRAW);
+
+        for(size_t i = 0; i < ranges.size(); i++) {
+            Range &range = ranges[i];
+            if(!range.live) continue;
+            size_t baseVertex = placed[i].baseVertex, indexOffset = placed[i].indexOffset;
+
+            glBindBuffer(GL_COPY_READ_BUFFER, VBO);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, newVBO);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, range.baseVertex * stride, baseVertex * stride, range.vertexCount * stride);
+            glBindBuffer(GL_COPY_READ_BUFFER, EBO);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, newEBO);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, range.indexOffset, indexOffset, range.indexBytes);
+
+            range.baseVertex = baseVertex;
+            range.indexOffset = indexOffset;
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        if(VBO) glDeleteBuffers(1, &VBO);
+        if(EBO) glDeleteBuffers(1, &EBO);
+        VBO = newVBO;
+        EBO = newEBO;
+        vertexAllocator = vertices;
+        indexAllocator = indices;
+        setupVertexArray();
+        return true;
+    }
+
+    // Atrybuty jak w shader.vert: 0 pozycja, 1 UV, 2 normalna (float), 3 normalna oktaedryczna
+    void setupVertexArray() {
+        bindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+        if(format == VertexFormat::Packed) {
+            // 1. Pozycja (location = 0) - unorm16, shader skaluje przez posOffset/posScale
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, Position));
+
+            // 2. Tekstury (location = 1) - half float
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, TexCoords));
+
+            // 3. Normalne oktaedryczne (location = 3) - snorm16, dekodowane w shaderze
+            glEnableVertexAttribArray(3);
+            glVertexAttribPointer(3, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, Normal));
+        } else {
+            // 1. Pozycja (location = 0)
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+
+            // 2. Tekstury (location = 1) - Żeby pasowało do Shadera i Podłogi!
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+
+            // 3. Normalne (location = 2)
+            glEnableVertexAttribArray(2);
+            glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef INDIRECT_DRAW_H
+#define INDIRECT_DRAW_H
+
+// Ścieżka GL 4.3: cała kolejka aut jako komendy DrawElementsIndirectCommand w GL_DRAW_INDIRECT_BUFFER,
+// wysyłana kilkoma glMultiDrawElementsIndirect (po jednym na program/teksturę/VAO/typ indeksów).
+// Dane rysowania (DrawRecord) i instancje czyta shader_mdi.vert z buforów SSBO:
+//  - numer rysowania = baseInstance komendy, podany atrybutem 12 z dzielnikiem 2^30
+//    (indeks elementu = baseInstance + instancja / dzielnik, więc stały w całej komendzie),
+//  - instancja = instances[draws[numer].firstInstance + gl_InstanceID].
+
+#include <glad/glad.h>
+
+#include "GLExtensions.h"
+#include "GeometryArena.h"
+#include "UniformBuffers.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+// Układ std430 zgodny z DrawRecord w shader_mdi.vert
+struct DrawRecord {
+    DrawUniforms uniforms;
+    uint32_t firstInstance;
+    uint32_t padding[3];
+};
+static_assert(sizeof(DrawRecord) == 192, "DrawRecord musi odpowiadac strukturze w shader_mdi.vert (std430)");
+
+class IndirectBuffers {
+public:
+    static constexpr GLuint DRAW_RECORD_BINDING = 2;
+    static constexpr GLuint INSTANCE_BINDING = 3;
+    static constexpr GLuint DRAW_ID_DIVISOR = 1u << 30;
+
+    IndirectBuffers() {
+        glGenBuffers(1, &commandBuffer);
+        glGenBuffers(1, &recordBuffer);
+        glGenBuffers(1, &drawIdBuffer);
+    }
+
+    ~IndirectBuffers() {
+        glDeleteBuffers(1, &commandBuffer);
+        glDeleteBuffers(1, &recordBuffer);
+        glDeleteBuffers(1, &drawIdBuffer);
+    }
+
+    IndirectBuffers(const IndirectBuffers&) = delete;
+    IndirectBuffers& operator=(const IndirectBuffers&) = delete;
+
+    // Raz na klatkę: komendy + rekordy (osierocenie i jeden zapis każdego bufora)
+    void upload(const std::vector<DrawElementsIndirectCommand> &commands, const std::vector<DrawRecord> &records) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), GL_STREAM_DRAW);
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, recordBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(records.size(), 1) * sizeof(DrawRecord), nullptr, GL_STREAM_DRAW);
+        if(!records.empty()) glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, records.size() * sizeof(DrawRecord), records.data());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_RECORD_BINDING, recordBuffer);
+
+        // Numery rysowań 0..N-1 (stałe, rosną tylko przy większej kolejce)
+        if(records.size() > drawIdCapacity) {
+            drawIdCapacity = std::max(records.size(), drawIdCapacity * 2);
+            std::vector<uint32_t> ids(drawIdCapacity);
+            std::iota(ids.begin(), ids.end(), 0u);
+            glBindBuffer(GL_ARRAY_BUFFER, drawIdBuffer);
+            glBufferData(GL_ARRAY_BUFFER, ids.size() * sizeof(uint32_t), ids.data(), GL_STATIC_DRAW);
+        }
+    }
+
+    GLuint drawIds() const { return drawIdBuffer; }
+
+private:
+    GLuint commandBuffer = 0;
+    GLuint recordBuffer = 0;
+    GLuint drawIdBuffer = 0;
+    size_t drawIdCapacity = 0;
+};
+
+#endif
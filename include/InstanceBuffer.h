@@ -0,0 +1,49 @@
+#ifndef INSTANCE_BUFFER_H
+#define INSTANCE_BUFFER_H
+
+// Bufor instancji aut (InstanceData) zapisywany raz na klatkę: scena dokłada instancje partiami
+// (jedna partia = jeden model), upload() osieraca bufor i wysyła całość jednym glBufferSubData.
+
+#include <glad/glad.h>
+
+#include "Vertex.h"
+
+#include <algorithm>
+#include <vector>
+
+class InstanceBuffer {
+public:
+    InstanceBuffer() { glGenBuffers(1, &buffer); }
+    ~InstanceBuffer() { glDeleteBuffers(1, &buffer); }
+
+    InstanceBuffer(const InstanceBuffer&) = delete;
+    InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+    // Numer instancji w buforze; kolejne wywołania dają kolejne numery (partia = ciągły zakres)
+    size_t push(const InstanceData &instance) {
+        instances.push_back(instance);
+        return instances.size() - 1;
+    }
+
+    size_t size() const { return instances.size(); }
+
+    void upload() {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        size_t bytes = instances.size() * sizeof(InstanceData);
+        if(bytes > capacity) capacity = std::max(bytes, capacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_STREAM_DRAW); // osierocenie
+        if(bytes) glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances.data());
+        instances.clear();
+    }
+
+    GLuint id() const { return buffer; }
+
+    static size_t offsetOf(size_t instance) { return instance * sizeof(InstanceData); }
+
+private:
+    GLuint buffer = 0;
+    size_t capacity = 0;
+    std::vector<InstanceData> instances;
+};
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+    #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// Plik zmapowany w pamięć tylko do odczytu (RAII)
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string &path) {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) { close(); return false; }
+        size = static_cast<size_t>(fileSize.QuadPart);
+
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!mapping) { close(); return false; }
+
+        data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!data) { close(); return false; }
+#else
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) { close(); return false; }
+        size = static_cast<size_t>(st.st_size);
+
+        void* ptr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED) { close(); return false; }
+        data = static_cast<const unsigned char*>(ptr);
+#endif
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = NULL;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (data) munmap(const_cast<unsigned char*>(data), size);
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        data = nullptr;
+        size = 0;
+    }
+
+    const unsigned char* bytes() const { return data; }
+    size_t length() const { return size; }
+
+private:
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#else
+    int fd = -1;
+#endif
+};
+
+// Rozmiar i czas modyfikacji pliku - znacznik, po którym poznajemy nieaktualny cache
+inline bool fileStamp(const std::string &path, uint64_t &size, int64_t &time) {
+    std::error_code ec;
+    size = static_cast<uint64_t>(std::filesystem::file_size(path, ec));
+    if (ec) return false;
+    time = static_cast<int64_t>(std::filesystem::last_write_time(path, ec).time_since_epoch().count());
+    return !ec;
+}
+
+inline size_t padTo4(size_t n) { return (n + 3) & ~size_t(3); }
+
+// Prosty czytnik z kontrolą granic - nullptr/false oznacza "plik uszkodzony"
+class ByteReader {
+public:
+    ByteReader(const unsigned char* data, size_t size) : cursor(data), end(data + size) {}
+
+    template<typename T>
+    const T* take(size_t count = 1) {
+        size_t bytes = count * sizeof(T);
+        if (static_cast<size_t>(end - cursor) < bytes) return nullptr;
+        const T* result = reinterpret_cast<const T*>(cursor);
+        cursor += bytes;
+        return result;
+    }
+
+    bool readString(std::string &str) {
+        const uint32_t* length = take<uint32_t>();
+        if (!length) return false;
+        const char* chars = take<char>(padTo4(*length));
+        if (!chars) return false;
+        str.assign(chars, *length);
+        return true;
+    }
+
+private:
+    const unsigned char* cursor;
+    const unsigned char* end;
+};
+
+#endif
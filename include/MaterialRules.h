@@ -0,0 +1,114 @@
+#ifndef MATERIAL_RULES_H
+#define MATERIAL_RULES_H
+
+// Klasyfikacja materiałów aut przy wczytywaniu (zamiast szukania napisów w każdej klatce).
+// Reguły są w pliku models/materials.txt: "model wzorzec klasa tiling", pierwsza pasująca wygrywa.
+// Klasa i tiling wyznaczają też wariant shadera (ShaderVariants) - wybierany tu, raz na materiał.
+
+#include "ShaderVariants.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Skąd siatka bierze teksturę - Paint to lakier stanowiska, reszta to wspólne tekstury salonu
+enum class MaterialClass : uint8_t { Paint, Tire, Steel, Red, Light, Glass, Count };
+
+// Wynik klasyfikacji trzymany w siatce - pętla rysująca tylko go odczytuje
+struct MaterialRecord {
+    MaterialClass materialClass = MaterialClass::Paint;
+    float tiling = 1.0f;
+    uint32_t shaderFeatures = SHADER_PAINT; // maska ShaderFeature - wariant programu dla tej siatki
+};
+
+class MaterialRules {
+public:
+    bool load(const std::string &path) {
+        std::ifstream in(path);
+        if(!in) {
+            std::cout << "Brak pliku regul materialow: " << path << std::endl;
+            return false;
+        }
+
+        rules.clear();
+        std::string line;
+        int lineNumber = 0;
+        while(std::getline(in, line)) {
+            lineNumber++;
+            size_t comment = line.find('#');
+            if(comment != std::string::npos) line.erase(comment);
+
+            std::istringstream fields(line);
+            Rule rule;
+            std::string className;
+            if(!(fields >> rule.model)) continue; // pusta linia
+            if(!(fields >> rule.pattern >> className >> rule.record.tiling) || !parseClass(className, rule.record.materialClass)) {
+                std::cout << path << ":" << lineNumber << ": niepoprawna regula materialu" << std::endl;
+                continue;
+            }
+            rule.record.shaderFeatures = shaderFeaturesFor(rule.record);
+            rules.push_back(rule);
+        }
+        return true;
+    }
+
+    // modelName = nazwa pliku bez rozszerzenia, np. "car-1"
+    MaterialRecord classify(const std::string &modelName, const std::string &materialName) const {
+        for(const Rule &rule : rules) {
+            if(rule.model != "*" && rule.model != modelName) continue;
+            if(rule.pattern != "*" && materialName.find(rule.pattern) == std::string::npos) continue;
+            return rule.record;
+        }
+        return MaterialRecord();
+    }
+
+    // Wszystkie warianty, które mogą wyjść z reguł (i z domyślnego lakieru) - do skompilowania przy starcie
+    std::vector<uint32_t> shaderFeatures() const {
+        std::vector<uint32_t> features = { MaterialRecord().shaderFeatures };
+        for(const Rule &rule : rules)
+            if(std::find(features.begin(), features.end(), rule.record.shaderFeatures) == features.end())
+                features.push_back(rule.record.shaderFeatures);
+        return features;
+    }
+
+    static uint32_t shaderFeaturesFor(const MaterialRecord &record) {
+        uint32_t features = record.materialClass == MaterialClass::Paint ? SHADER_PAINT : SHADER_TEXTURED;
+        if(record.materialClass == MaterialClass::Glass) features |= SHADER_GLASS;
+        if(record.materialClass == MaterialClass::Light) features |= SHADER_EMISSIVE;
+        if(record.tiling != 1.0f) features |= SHADER_TILING;
+        return features;
+    }
+
+    // models/car-1.obj -> car-1
+    static std::string modelNameFor(const std::string &path) {
+        size_t slash = path.find_last_of("/\\");
+        std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+        size_t dot = name.find_last_of('.');
+        return dot == std::string::npos ? name : name.substr(0, dot);
+    }
+
+    static bool parseClass(const std::string &name, MaterialClass &out) {
+        static const char* NAMES[] = { "paint", "tire", "steel", "red", "light", "glass" };
+        for(int i = 0; i < static_cast<int>(MaterialClass::Count); i++) {
+            if(name == NAMES[i]) {
+                out = static_cast<MaterialClass>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    struct Rule {
+        std::string model;
+        std::string pattern;
+        MaterialRecord record;
+    };
+    std::vector<Rule> rules;
+};
+
+#endif
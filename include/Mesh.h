@@ -4,19 +4,22 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
 
+#include "Bvh.h"
 #include "Shader.h"
+#include "GeometryArena.h"
+#include "MaterialRules.h"
+#include "Vertex.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <string>
 #include <vector>
 
-// Struktura reprezentująca jeden wierzchołek
-struct Vertex {
-    glm::vec3 Position;  // Gdzie jest?
-    glm::vec3 Normal;    // W którą stronę patrzy ściana? (do oświetlenia)
-    glm::vec2 TexCoords; // Jak nałożyć teksturę?
-};
-
 // Struktura reprezentująca teksturę
 struct Texture {
     unsigned int id;
@@ -24,92 +27,259 @@ struct Texture {
     std::string path; // ścieżka do pliku
 };
 
+// Odwołanie do tekstury materiału (bez obiektu GL) - zapisywane w pliku .bin
+struct TextureRef {
+    std::string type; // np. "texture_diffuse"
+    std::string path; // ścieżka względem katalogu modelu
+};
+
+// Poziom szczegółów: fragment wspólnej listy indeksów (te same wierzchołki) - zapisywany w pliku .bin
+struct MeshLod {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float    error; // błąd geometryczny względem LOD0, w jednostkach modelu
+};
+
+// Dane siatki po stronie CPU (wynik importu, jeszcze bez buforów GL)
+struct MeshData {
+    std::vector<Vertex>       vertices;
+    std::vector<unsigned int> indices; // LOD0, a za nim kolejne LOD-y
+    std::vector<MeshLod>      lods;
+    std::vector<TextureRef>   textures;
+    std::string materialName;
+};
+
 class Mesh {
 public:
     // Dane siatki
     std::vector<Vertex>       vertices;
     std::vector<unsigned int> indices;
     std::vector<Texture>      textures;
-    unsigned int VAO;
+    GeometryArena* arena;     // wspólne bufory, z których siatka dostała podzakres
+    unsigned int arenaHandle;
+    unsigned int indexCount;
+    GLenum indexType;      // GL_UNSIGNED_SHORT, gdy siatka ma co najwyżej 65536 wierzchołków (indeksy 0..65535)
+
+    // AABB w przestrzeni modelu - do dekwantyzacji pozycji
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+    // Sfera otaczająca (środek AABB, promień do najdalszego wierzchołka) - do odrzucania poza frustumem
+    glm::vec3 sphereCenter;
+    float sphereRadius;
+    // Trójkąty LOD0 do trafień promieniem (wspólne dla kopii siatki; brak = tylko AABB)
+    std::shared_ptr<const TriangleBvh> triangleBvh;
+    bool compact;          // czy bufor ma układ PackedVertex
+    size_t gpuBytes;       // rozmiar zakresu w VBO + EBO areny
 
     std::string materialName;
+    MaterialRecord material; // klasa i tiling ustalone przy wczytywaniu (Model::uploadMesh)
+
+    // LOD0 = pełna siatka; currentLod wybiera selectLod przed rysowaniem
+    std::vector<MeshLod> lods;
+    unsigned int currentLod = 0;
+
+    // Włączane parametrem "--compact" - dotyczy siatek wysyłanych później
+    static inline bool useCompactVertices = false;
+
+    // Dopuszczalny błąd LOD na ekranie (w pikselach) i zapas histerezy przy przejściu na grubszy poziom
+    static inline bool useLod = true;
+    static inline float lodPixelError = 1.0f;
+    static inline float lodHysteresis = 0.25f;
 
     // Konstruktor
-    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures, std::string name = "") {
+    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures, std::string name = "",
+         std::vector<MeshLod> lods = {}) {
         this->vertices = vertices;
         this->indices = indices;
         this->textures = textures;
         this->materialName = name;
+        this->lods = lods;
 
         // Teraz ustawiamy bufory (to co robiłeś ręcznie w setupFloor, tutaj dzieje się automagicznie)
-        setupMesh();
+        setupMesh(this->vertices.data(), this->vertices.size(), this->indices.data(), this->indices.size());
+    }
+
+    // Konstruktor dla danych z pliku .bin: wysyłamy prosto z pamięci (mmap), bez kopii na CPU
+    Mesh(const Vertex* vertexData, size_t vertexCount, const unsigned int* indexData, size_t indexCount,
+         std::vector<Texture> textures, std::string name = "", std::vector<MeshLod> lods = {}) {
+        this->textures = textures;
+        this->materialName = name;
+        this->lods = lods;
+
+        setupMesh(vertexData, vertexCount, indexData, indexCount);
+    }
+
+    // Najgrubszy LOD, którego błąd na ekranie mieści się w progu. pixelsPerUnit = ile pikseli
+    // zajmuje jednostka modelu w odległości siatki. Grubszy poziom dopiero z zapasem histerezy,
+    // drobniejszy od razu - dzięki temu na granicy progu LOD nie migocze.
+    void selectLod(float pixelsPerUnit) {
+        if(!useLod) {
+            currentLod = 0;
+            return;
+        }
+        while(currentLod > 0 && lods[currentLod].error * pixelsPerUnit > lodPixelError)
+            currentLod--;
+        while(currentLod + 1 < lods.size() &&
+              lods[currentLod + 1].error * pixelsPerUnit <= lodPixelError * (1.0f - lodHysteresis))
+            currentLod++;
     }
 
-    // Funkcja rysująca siatkę
+    // Dekwantyzacja pozycji (DrawData): pos = posOffset + aPos * posScale, dla floatów 0 i 1
+    glm::vec3 positionOffset() const { return compact ? boundsMin : glm::vec3(0.0f); }
+    glm::vec3 positionScale() const { return compact ? boundsMax - boundsMin : glm::vec3(1.0f); }
+
+    // Funkcja rysująca siatkę (dane rysowania w bloku DrawData muszą już być podpięte)
     void Draw(Shader &shader) {
-        // Obsługa tekstur
-        unsigned int diffuseNr  = 1;
-        unsigned int specularNr = 1;
+        // Obsługa tekstur: samplery material.texture_diffuseN / texture_specularN (jeśli shader je ma)
+        static constexpr UniformName DIFFUSE[] = { "material.texture_diffuse1", "material.texture_diffuse2", "material.texture_diffuse3" };
+        static constexpr UniformName SPECULAR[] = { "material.texture_specular1", "material.texture_specular2", "material.texture_specular3" };
+
+        unsigned int diffuseNr  = 0;
+        unsigned int specularNr = 0;
 
         for(unsigned int i = 0; i < textures.size(); i++) {
             glActiveTexture(GL_TEXTURE0 + i); // aktywuj odpowiednią jednostkę tekstur
-            
-            // Pobieramy nazwę i numer (np. texture_diffuse1)
-            std::string number;
-            std::string name = textures[i].type;
-            if(name == "texture_diffuse")
-                number = std::to_string(diffuseNr++);
-            else if(name == "texture_specular")
-                number = std::to_string(specularNr++); // to przyda się później do błysku (specular)
-
-            // Ustawiamy w shaderze (np. material.texture_diffuse1)
-            shader.setInt(("material." + name + number).c_str(), i);
+
+            if(textures[i].type == "texture_diffuse" && diffuseNr < 3)
+                shader.setInt(DIFFUSE[diffuseNr++], i);
+            else if(textures[i].type == "texture_specular" && specularNr < 3)
+                shader.setInt(SPECULAR[specularNr++], i); // to przyda się później do błysku (specular)
             glBindTexture(GL_TEXTURE_2D, textures[i].id);
         }
         
-        // Rysowanie
-        glBindVertexArray(VAO);
-        // Uwaga: używamy glDrawElements (z indeksami), a nie glDrawArrays!
-        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+        // Rysowanie: wspólny VAO areny, siatka wskazana przez offset indeksów i baseVertex
+        arena->bind();
+        drawElements();
 
         // Reset
         glActiveTexture(GL_TEXTURE0);
     }
 
+    // Samo wywołanie rysowania - VAO areny i stan (program, DrawData) ustawia wołający (RenderQueue)
+    void drawElements() const {
+        const GeometryArena::Range &range = arena->range(arenaHandle);
+        // Uwaga: używamy glDrawElements (z indeksami), a nie glDrawArrays!
+        const MeshLod &lod = lods[currentLod];
+        size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+        glDrawElementsBaseVertex(GL_TRIANGLES, lod.indexCount, indexType, (void*)(range.indexOffset + lod.firstIndex * indexSize),
+                                 (GLint)range.baseVertex);
+    }
+
+    // Ta sama siatka "instanceCount" razy; atrybuty instancji ustawia GeometryArena::bindInstances
+    void drawElementsInstanced(unsigned int instanceCount) const {
+        const GeometryArena::Range &range = arena->range(arenaHandle);
+        const MeshLod &lod = lods[currentLod];
+        size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, lod.indexCount, indexType, (void*)(range.indexOffset + lod.firstIndex * indexSize),
+                                          (GLsizei)instanceCount, (GLint)range.baseVertex);
+    }
+
+    // Bieżący LOD jako komenda rysowania pośredniego (firstIndex w elementach bufora indeksów areny)
+    DrawElementsIndirectCommand indirectCommand(unsigned int instanceCount, unsigned int baseInstance) const {
+        const GeometryArena::Range &range = arena->range(arenaHandle);
+        const MeshLod &lod = lods[currentLod];
+        size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+        DrawElementsIndirectCommand command;
+        command.count = lod.indexCount;
+        command.instanceCount = instanceCount;
+        command.firstIndex = static_cast<uint32_t>(range.indexOffset / indexSize) + lod.firstIndex;
+        command.baseVertex = static_cast<int32_t>(range.baseVertex);
+        command.baseInstance = baseInstance;
+        return command;
+    }
+
+    // Oddaje zakres areny (wywołuje Model przy zwalnianiu auta)
+    void release() {
+        if(!arena) return;
+        arena->release(arenaHandle);
+        arena = nullptr;
+    }
+
 private:
-    unsigned int VBO, EBO;
 
-    void setupMesh() {
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
+    void setupMesh(const Vertex* vertexData, size_t vertexCount, const unsigned int* indexData, size_t count) {
+        indexCount = static_cast<unsigned int>(count);
+        if(lods.empty()) lods.push_back({ 0, indexCount, 0.0f });
 
-        glBindVertexArray(VAO);
-        
-        // Wrzucamy wierzchołki
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+        boundsMin = glm::vec3(0.0f);
+        boundsMax = glm::vec3(0.0f);
+        if(vertexCount > 0) boundsMin = boundsMax = vertexData[0].Position;
+        float maxUV = 0.0f;
+        for(size_t i = 0; i < vertexCount; i++) {
+            boundsMin = glm::min(boundsMin, vertexData[i].Position);
+            boundsMax = glm::max(boundsMax, vertexData[i].Position);
+            maxUV = std::max(maxUV, std::max(std::abs(vertexData[i].TexCoords.x), std::abs(vertexData[i].TexCoords.y)));
+        }
+        sphereCenter = (boundsMin + boundsMax) * 0.5f;
+        float radiusSquared = 0.0f;
+        for(size_t i = 0; i < vertexCount; i++) {
+            glm::vec3 offset = vertexData[i].Position - sphereCenter;
+            radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+        }
+        sphereRadius = std::sqrt(radiusSquared);
+        // Half float traci precyzję UV przy dużych wartościach (mocny tiling w samym modelu)
+        compact = useCompactVertices && maxUV <= 64.0f;
 
-        // Wrzucamy indeksy (EBO - Element Buffer Object) - wymaganie projektowe!
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+        // Wierzchołki w formacie areny
+        std::vector<PackedVertex> packed;
+        const void* vertexBytes = vertexData;
+        if(compact) {
+            packed = packVertices(vertexData, vertexCount);
+            vertexBytes = packed.data();
+        }
+        arena = &GeometryArena::get(compact ? VertexFormat::Packed : VertexFormat::Full);
 
-        // 1. Pozycja (location = 0)
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-        
-        // --- ZMIANA KOLEJNOŚCI TUTAJ ---
+        // Indeksy (EBO - wymaganie projektowe!) są względne do baseVertex zakresu,
+        // więc przy co najwyżej 65536 wierzchołkach (indeksy 0..65535; primitive restart wyłączony, 0xFFFF
+        // to zwykły indeks) wystarczą indeksy 16-bitowe (połowa pamięci i przepustowości)
+        std::vector<uint16_t> shortIndices;
+        const void* indexBytes = indexData;
+        size_t indexSize = sizeof(unsigned int);
+        indexType = GL_UNSIGNED_INT;
+        if(vertexCount <= 65536) {
+            shortIndices.assign(indexData, indexData + count);
+            indexBytes = shortIndices.data();
+            indexSize = sizeof(uint16_t);
+            indexType = GL_UNSIGNED_SHORT;
+        }
 
-        // 2. Tekstury (location = 1) - Żeby pasowało do Shadera i Podłogi!
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+        arenaHandle = arena->allocate(vertexBytes, vertexCount, indexBytes, count * indexSize);
+        gpuBytes = vertexCount * (compact ? sizeof(PackedVertex) : sizeof(Vertex)) + count * indexSize;
+    }
 
-        // 3. Normalne (location = 2) - Przesuwamy na później (przydadzą się do światła)
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+    // Normalna -> oktaedr rozłożony na kwadrat [-1,1]^2
+    static glm::vec2 encodeOctahedral(glm::vec3 n) {
+        float sum = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+        if(sum == 0.0f) return glm::vec2(0.0f);
+        n /= sum;
+        glm::vec2 e(n.x, n.y);
+        if(n.z < 0.0f) {
+            e = glm::vec2((1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+                          (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+        }
+        return e;
+    }
 
-        glBindVertexArray(0);
+    std::vector<PackedVertex> packVertices(const Vertex* vertexData, size_t vertexCount) const {
+        std::vector<PackedVertex> packed(vertexCount);
+        glm::vec3 extent = boundsMax - boundsMin;
+        glm::vec3 invExtent(extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+                            extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+                            extent.z > 0.0f ? 1.0f / extent.z : 0.0f);
+        for(size_t i = 0; i < vertexCount; i++) {
+            const Vertex &v = vertexData[i];
+            glm::vec3 unit = glm::clamp((v.Position - boundsMin) * invExtent, 0.0f, 1.0f);
+            packed[i].Position[0] = static_cast<uint16_t>(unit.x * 65535.0f + 0.5f);
+            packed[i].Position[1] = static_cast<uint16_t>(unit.y * 65535.0f + 0.5f);
+            packed[i].Position[2] = static_cast<uint16_t>(unit.z * 65535.0f + 0.5f);
+            packed[i].Position[3] = 0;
+
+            uint32_t normal = glm::packSnorm2x16(encodeOctahedral(v.Normal));
+            uint32_t uv = glm::packHalf2x16(v.TexCoords);
+            std::memcpy(packed[i].Normal, &normal, sizeof(normal));
+            std::memcpy(packed[i].TexCoords, &uv, sizeof(uv));
+        }
+        return packed;
     }
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,269 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+// Optymalizacja siatki przy imporcie (CPU, bez OpenGL):
+//  1. spawanie identycznych wierzchołków,
+//  2. usuwanie zdegenerowanych trójkątów,
+//  3. kolejność trójkątów pod cache wierzchołków po transformacji (Tipsify),
+//  4. kolejność klastrów pod overdraw (najpierw to, co zasłania),
+//  5. kolejność wierzchołków pod pobieranie z pamięci (pierwsze użycie).
+
+#include "Mesh.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+namespace MeshOptimizer {
+
+// Rozmiar symulowanego cache FIFO (bezpieczny dla starszych GPU)
+const unsigned int CACHE_SIZE = 16;
+
+// Kolejność pod overdraw nie może pogorszyć ACMR bardziej niż o 5%
+const float OVERDRAW_ACMR_THRESHOLD = 1.05f;
+
+struct Stats {
+    size_t verticesBefore = 0, verticesAfter = 0;
+    size_t trianglesBefore = 0, trianglesAfter = 0;
+    float acmrBefore = 0.0f, acmrAfter = 0.0f;
+};
+
+// Średnia liczba transformacji wierzchołka na trójkąt (Average Cache Miss Ratio)
+inline float computeACMR(const std::vector<unsigned int> &indices, size_t vertexCount, unsigned int cacheSize = CACHE_SIZE) {
+    if(indices.size() < 3) return 0.0f;
+    std::vector<unsigned int> cacheTime(vertexCount, 0);
+    unsigned int time = cacheSize + 1;
+    size_t misses = 0;
+    for(unsigned int v : indices) {
+        if(time - cacheTime[v] > cacheSize) {
+            cacheTime[v] = time++;
+            misses++;
+        }
+    }
+    return static_cast<float>(misses) / (indices.size() / 3);
+}
+
+struct VertexHash {
+    size_t operator()(const Vertex &v) const {
+        // FNV-1a po bajtach wierzchołka
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&v);
+        uint64_t hash = 1469598103934665603ull;
+        for(size_t i = 0; i < sizeof(Vertex); i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+
+struct VertexEqual {
+    bool operator()(const Vertex &a, const Vertex &b) const {
+        return std::memcmp(&a, &b, sizeof(Vertex)) == 0;
+    }
+};
+
+inline void weldVertices(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices) {
+    std::unordered_map<Vertex, unsigned int, VertexHash, VertexEqual> unique;
+    unique.reserve(vertices.size());
+    std::vector<Vertex> welded;
+    welded.reserve(vertices.size());
+    std::vector<unsigned int> remap(vertices.size());
+
+    for(size_t i = 0; i < vertices.size(); i++) {
+        auto it = unique.emplace(vertices[i], static_cast<unsigned int>(welded.size()));
+        if(it.second) welded.push_back(vertices[i]);
+        remap[i] = it.first->second;
+    }
+    for(unsigned int &index : indices)
+        index = remap[index];
+    vertices.swap(welded);
+}
+
+// Trójkąty z powtórzonym indeksem lub pozycją mają zerowe pole - nic nie rysują
+inline void removeDegenerates(const std::vector<Vertex> &vertices, std::vector<unsigned int> &indices) {
+    size_t out = 0;
+    for(size_t i = 0; i + 2 < indices.size(); i += 3) {
+        unsigned int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        if(a == b || b == c || a == c) continue;
+        const glm::vec3 &pa = vertices[a].Position, &pb = vertices[b].Position, &pc = vertices[c].Position;
+        if(pa == pb || pb == pc || pa == pc) continue;
+        indices[out++] = a;
+        indices[out++] = b;
+        indices[out++] = c;
+    }
+    indices.resize(out);
+}
+
+// Tipsify (Sander, Nehab, Barczak 2007): wachlarze wokół wierzchołków, które wciąż są w cache
+inline std::vector<unsigned int> tipsify(const std::vector<unsigned int> &indices, size_t vertexCount, unsigned int cacheSize = CACHE_SIZE) {
+    size_t triangleCount = indices.size() / 3;
+
+    // Lista trójkątów każdego wierzchołka (CSR)
+    std::vector<unsigned int> liveTriangles(vertexCount, 0);
+    for(unsigned int v : indices) liveTriangles[v]++;
+    std::vector<unsigned int> adjacencyOffset(vertexCount + 1, 0);
+    for(size_t v = 0; v < vertexCount; v++) adjacencyOffset[v + 1] = adjacencyOffset[v] + liveTriangles[v];
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+    for(size_t t = 0; t < triangleCount; t++)
+        for(int k = 0; k < 3; k++)
+            adjacency[fill[indices[t * 3 + k]]++] = static_cast<unsigned int>(t);
+
+    std::vector<unsigned int> cacheTime(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> deadEnd;
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+
+    unsigned int time = cacheSize + 1;
+    size_t cursor = 0;
+    long fan = vertexCount > 0 ? 0 : -1;
+
+    while(fan >= 0) {
+        candidates.clear();
+        for(unsigned int a = adjacencyOffset[fan]; a < adjacencyOffset[fan + 1]; a++) {
+            unsigned int t = adjacency[a];
+            if(emitted[t]) continue;
+            for(int k = 0; k < 3; k++) {
+                unsigned int v = indices[t * 3 + k];
+                result.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+                if(time - cacheTime[v] > cacheSize) cacheTime[v] = time++;
+            }
+            emitted[t] = true;
+        }
+
+        // Następny wachlarz: wierzchołek, który zostanie w cache po obsłużeniu jego trójkątów
+        long next = -1;
+        long bestPriority = -1;
+        for(unsigned int v : candidates) {
+            if(liveTriangles[v] == 0) continue;
+            long priority = 0;
+            if(time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize) priority = time - cacheTime[v];
+            if(priority > bestPriority) { bestPriority = priority; next = v; }
+        }
+
+        // Ślepy zaułek: ostatnio użyte wierzchołki, a potem kolejne wierzchołki z wejścia
+        while(next < 0 && !deadEnd.empty()) {
+            unsigned int v = deadEnd.back();
+            deadEnd.pop_back();
+            if(liveTriangles[v] > 0) next = v;
+        }
+        while(next < 0 && cursor < vertexCount) {
+            if(liveTriangles[cursor] > 0) next = static_cast<long>(cursor);
+            cursor++;
+        }
+        fan = next;
+    }
+    return result;
+}
+
+// Klastry rozcinamy tam, gdzie trójkąt i tak był pełnym chybieniem cache (3 nowe wierzchołki),
+// więc zmiana ich kolejności prawie nie psuje ACMR. Klastry skierowane "na zewnątrz" idą pierwsze.
+inline std::vector<unsigned int> optimizeOverdraw(const std::vector<unsigned int> &indices, const std::vector<Vertex> &vertices, unsigned int cacheSize = CACHE_SIZE) {
+    size_t triangleCount = indices.size() / 3;
+    std::vector<size_t> clusterStart;
+    std::vector<unsigned int> cacheTime(vertices.size(), 0);
+    unsigned int time = cacheSize + 1;
+    for(size_t t = 0; t < triangleCount; t++) {
+        int misses = 0;
+        for(int k = 0; k < 3; k++) {
+            unsigned int v = indices[t * 3 + k];
+            if(time - cacheTime[v] > cacheSize) { cacheTime[v] = time++; misses++; }
+        }
+        if(t == 0 || misses == 3) clusterStart.push_back(t);
+    }
+    if(clusterStart.size() < 2) return indices;
+    clusterStart.push_back(triangleCount);
+
+    // Środek siatki ważony polem
+    glm::vec3 meshCenter(0.0f);
+    float meshArea = 0.0f;
+    std::vector<glm::vec3> triangleCenter(triangleCount), triangleNormal(triangleCount);
+    for(size_t t = 0; t < triangleCount; t++) {
+        const glm::vec3 &a = vertices[indices[t * 3]].Position, &b = vertices[indices[t * 3 + 1]].Position, &c = vertices[indices[t * 3 + 2]].Position;
+        glm::vec3 n = glm::cross(b - a, c - a); // długość = 2 * pole
+        float area = glm::length(n) * 0.5f;
+        triangleCenter[t] = (a + b + c) / 3.0f;
+        triangleNormal[t] = n * 0.5f;
+        meshCenter += triangleCenter[t] * area;
+        meshArea += area;
+    }
+    if(meshArea > 0.0f) meshCenter /= meshArea;
+
+    size_t clusterCount = clusterStart.size() - 1;
+    std::vector<float> sortKey(clusterCount);
+    for(size_t c = 0; c < clusterCount; c++) {
+        glm::vec3 center(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for(size_t t = clusterStart[c]; t < clusterStart[c + 1]; t++) {
+            float a = glm::length(triangleNormal[t]);
+            center += triangleCenter[t] * a;
+            normal += triangleNormal[t];
+            area += a;
+        }
+        if(area > 0.0f) center /= area;
+        float normalLength = glm::length(normal);
+        sortKey[c] = normalLength > 0.0f ? glm::dot(center - meshCenter, normal / normalLength) : 0.0f;
+    }
+
+    std::vector<size_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKey[a] > sortKey[b]; });
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    for(size_t c : order)
+        result.insert(result.end(), indices.begin() + clusterStart[c] * 3, indices.begin() + clusterStart[c + 1] * 3);
+    return result;
+}
+
+// Wierzchołki w kolejności pierwszego użycia; nieużywane wypadają
+inline void optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices) {
+    const unsigned int UNUSED = ~0u;
+    std::vector<unsigned int> remap(vertices.size(), UNUSED);
+    std::vector<Vertex> ordered;
+    ordered.reserve(vertices.size());
+    for(unsigned int &index : indices) {
+        if(remap[index] == UNUSED) {
+            remap[index] = static_cast<unsigned int>(ordered.size());
+            ordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(ordered);
+}
+
+// Cały proces dla jednej siatki
+inline Stats optimize(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices) {
+    Stats stats;
+    stats.verticesBefore = vertices.size();
+    stats.trianglesBefore = indices.size() / 3;
+    stats.acmrBefore = computeACMR(indices, vertices.size());
+
+    weldVertices(vertices, indices);
+    removeDegenerates(vertices, indices);
+
+    indices = tipsify(indices, vertices.size());
+    float tipsifyAcmr = computeACMR(indices, vertices.size());
+    std::vector<unsigned int> overdrawOrder = optimizeOverdraw(indices, vertices);
+    if(computeACMR(overdrawOrder, vertices.size()) <= tipsifyAcmr * OVERDRAW_ACMR_THRESHOLD)
+        indices.swap(overdrawOrder);
+
+    optimizeVertexFetch(vertices, indices);
+
+    stats.verticesAfter = vertices.size();
+    stats.trianglesAfter = indices.size() / 3;
+    stats.acmrAfter = computeACMR(indices, vertices.size());
+    return stats;
+}
+
+} // namespace MeshOptimizer
+
+#endif
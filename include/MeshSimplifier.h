@@ -0,0 +1,303 @@
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+// Poziomy szczegółów (LOD) liczone przy imporcie (CPU, bez OpenGL):
+//  - ściąganie krawędzi z metryką kwadryk (Garland, Heckbert 1997),
+//  - wierzchołek zawsze ściągany do sąsiada, więc LOD-y to tylko nowe listy indeksów
+//    na tych samych wierzchołkach (jeden zakres w arenie, bez kopii VBO),
+//  - szwy UV/normalnych ściągane razem po obu stronach, brzegi siatki (granice materiałów -
+//    każdy materiał to osobna siatka) są zablokowane.
+
+#include "Mesh.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace MeshSimplifier {
+
+// Kolejne poziomy: ułamek trójkątów LOD0
+const float LOD_RATIOS[] = { 0.5f, 0.25f, 0.125f };
+
+// Poziom, który nie zszedł poniżej 85% trójkątów poprzedniego, nie jest wart pamięci
+const float MIN_REDUCTION = 0.85f;
+
+// Największy dopuszczalny błąd jako ułamek przekątnej AABB siatki
+const float MAX_ERROR_RATIO = 0.05f;
+
+// Ściągnięcie nie może obrócić trójkąta bardziej niż o ~78 stopni
+const double MIN_NORMAL_COS = 0.2;
+
+// Symetryczna macierz 4x4 sumy kwadratów odległości od płaszczyzn, ważona polem
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+    double a11 = 0, a12 = 0, a13 = 0;
+    double a22 = 0, a23 = 0;
+    double a33 = 0;
+    double weight = 0;
+
+    void addPlane(const glm::dvec3 &n, double d, double w) {
+        a00 += w * n.x * n.x; a01 += w * n.x * n.y; a02 += w * n.x * n.z; a03 += w * n.x * d;
+        a11 += w * n.y * n.y; a12 += w * n.y * n.z; a13 += w * n.y * d;
+        a22 += w * n.z * n.z; a23 += w * n.z * d;
+        a33 += w * d * d;
+        weight += w;
+    }
+
+    void add(const Quadric &q) {
+        a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+        a11 += q.a11; a12 += q.a12; a13 += q.a13;
+        a22 += q.a22; a23 += q.a23;
+        a33 += q.a33;
+        weight += q.weight;
+    }
+
+    // Średni kwadrat odległości punktu od płaszczyzn (w jednostkach modelu^2)
+    double evaluate(const glm::vec3 &p) const {
+        double x = p.x, y = p.y, z = p.z;
+        double sum = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x
+                   + a11 * y * y + 2 * a12 * y * z + 2 * a13 * y
+                   + a22 * z * z + 2 * a23 * z
+                   + a33;
+        return weight > 0 ? std::max(sum, 0.0) / weight : 0.0;
+    }
+};
+
+struct PositionHash {
+    size_t operator()(const glm::vec3 &p) const {
+        uint32_t bits[3];
+        std::memcpy(bits, &p, sizeof(bits));
+        return static_cast<size_t>(bits[0] * 73856093u ^ bits[1] * 19349663u ^ bits[2] * 83492791u);
+    }
+};
+
+// Stan upraszczania - kolejne LOD-y startują od wyniku poprzedniego.
+// Ściągamy całe pozycje: wierzchołki o tej samej pozycji (szew UV / twarda krawędź)
+// idą razem, każdy do swojego odpowiednika po tej samej stronie szwu.
+struct State {
+    const std::vector<Vertex>* vertices = nullptr;
+    std::vector<unsigned int> positionId;     // wierzchołek -> pozycja
+    std::vector<unsigned int> positionOffset; // pozycja -> jej wierzchołki (CSR)
+    std::vector<unsigned int> positionVertices;
+    std::vector<Quadric> quadrics;            // na pozycję
+    std::vector<unsigned char> locked;        // na pozycję: brzeg siatki
+    std::vector<unsigned int> indices;
+    float error = 0.0f; // największy błąd wykonanego ściągnięcia (odległość w jednostkach modelu)
+};
+
+inline uint64_t edgeKey(uint64_t a, uint64_t b) {
+    return std::min(a, b) << 32 | std::max(a, b);
+}
+
+inline State prepare(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices) {
+    State state;
+    state.vertices = &vertices;
+    state.indices = indices;
+
+    std::unordered_map<glm::vec3, unsigned int, PositionHash> positionIds;
+    positionIds.reserve(vertices.size());
+    state.positionId.resize(vertices.size());
+    for(size_t v = 0; v < vertices.size(); v++)
+        state.positionId[v] = positionIds.emplace(vertices[v].Position, static_cast<unsigned int>(positionIds.size())).first->second;
+
+    size_t positionCount = positionIds.size();
+    state.positionOffset.assign(positionCount + 1, 0);
+    for(unsigned int p : state.positionId) state.positionOffset[p + 1]++;
+    for(size_t p = 0; p < positionCount; p++) state.positionOffset[p + 1] += state.positionOffset[p];
+    state.positionVertices.resize(vertices.size());
+    std::vector<unsigned int> fill(state.positionOffset.begin(), state.positionOffset.end() - 1);
+    for(size_t v = 0; v < vertices.size(); v++)
+        state.positionVertices[fill[state.positionId[v]]++] = static_cast<unsigned int>(v);
+
+    state.quadrics.resize(positionCount);
+    for(size_t t = 0; t + 2 < indices.size(); t += 3) {
+        const glm::vec3 &a = vertices[indices[t]].Position, &b = vertices[indices[t + 1]].Position, &c = vertices[indices[t + 2]].Position;
+        glm::dvec3 n = glm::cross(glm::dvec3(b - a), glm::dvec3(c - a));
+        double length = glm::length(n);
+        if(length <= 0.0) continue;
+        n /= length;
+        double d = -glm::dot(n, glm::dvec3(a));
+        for(int k = 0; k < 3; k++)
+            state.quadrics[state.positionId[indices[t + k]]].addPlane(n, d, length * 0.5);
+    }
+
+    // Brzeg: krawędź (po pozycjach) należąca do jednego trójkąta - tu styka się inny materiał albo dziura
+    state.locked.assign(positionCount, 0);
+    std::unordered_map<uint64_t, unsigned int> edgeUses;
+    edgeUses.reserve(indices.size());
+    for(size_t t = 0; t + 2 < indices.size(); t += 3)
+        for(int k = 0; k < 3; k++)
+            edgeUses[edgeKey(state.positionId[indices[t + k]], state.positionId[indices[t + (k + 1) % 3]])]++;
+    for(size_t t = 0; t + 2 < indices.size(); t += 3) {
+        for(int k = 0; k < 3; k++) {
+            unsigned int a = state.positionId[indices[t + k]], b = state.positionId[indices[t + (k + 1) % 3]];
+            if(edgeUses[edgeKey(a, b)] == 1) {
+                state.locked[a] = 1;
+                state.locked[b] = 1;
+            }
+        }
+    }
+    return state;
+}
+
+// Jedno przejście: najtańsze ściągnięcia, które nie dotykają się nawzajem (wtedy sąsiedztwo jest aktualne).
+// Zwraca false, gdy nic nie dało się już ściągnąć.
+inline bool collapsePass(State &state, size_t targetTriangles, float maxError) {
+    const std::vector<Vertex> &vertices = *state.vertices;
+    const std::vector<unsigned int> &positionId = state.positionId;
+    std::vector<unsigned int> &indices = state.indices;
+    size_t vertexCount = vertices.size();
+    size_t triangleCount = indices.size() / 3;
+
+    // Trójkąty każdego wierzchołka (CSR, jak w Tipsify)
+    std::vector<unsigned int> adjacencyOffset(vertexCount + 1, 0);
+    for(unsigned int v : indices) adjacencyOffset[v + 1]++;
+    for(size_t v = 0; v < vertexCount; v++) adjacencyOffset[v + 1] += adjacencyOffset[v];
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+    for(size_t t = 0; t < triangleCount; t++)
+        for(int k = 0; k < 3; k++)
+            adjacency[fill[indices[t * 3 + k]]++] = static_cast<unsigned int>(t);
+
+    struct Collapse {
+        unsigned int from, to; // pozycje
+        double cost;
+    };
+    std::vector<Collapse> collapses;
+    collapses.reserve(indices.size());
+    double maxCost = static_cast<double>(maxError) * maxError;
+    for(size_t t = 0; t < triangleCount; t++) {
+        for(int k = 0; k < 3; k++) {
+            unsigned int a = positionId[indices[t * 3 + k]], b = positionId[indices[t * 3 + (k + 1) % 3]];
+            for(int dir = 0; dir < 2; dir++) {
+                unsigned int from = dir ? b : a, to = dir ? a : b;
+                if(state.locked[from]) continue;
+                Quadric q = state.quadrics[from];
+                q.add(state.quadrics[to]);
+                double cost = q.evaluate(vertices[state.positionVertices[state.positionOffset[to]]].Position);
+                if(cost <= maxCost) collapses.push_back({ from, to, cost });
+            }
+        }
+    }
+    if(collapses.empty()) return false;
+    std::sort(collapses.begin(), collapses.end(), [](const Collapse &x, const Collapse &y) { return x.cost < y.cost; });
+
+    // Ściągnięcie usuwa zwykle 2 trójkąty
+    size_t collapseLimit = (triangleCount - targetTriangles) / 2 + 1;
+    std::vector<unsigned int> remap(vertexCount);
+    for(size_t v = 0; v < vertexCount; v++) remap[v] = static_cast<unsigned int>(v);
+    std::vector<unsigned char> touched(state.quadrics.size(), 0);
+    std::vector<unsigned int> targets;
+    size_t performed = 0;
+
+    for(const Collapse &c : collapses) {
+        if(performed >= collapseLimit) break;
+        if(touched[c.from] || touched[c.to]) continue;
+
+        // Każdy wierzchołek pozycji "from" musi mieć dokładnie jednego sąsiada na pozycji "to"
+        // (tę samą stronę szwu) - inaczej ściągnięcie rozerwałoby UV albo normalne
+        bool valid = true;
+        targets.clear();
+        for(unsigned int g = state.positionOffset[c.from]; g < state.positionOffset[c.from + 1] && valid; g++) {
+            unsigned int v = state.positionVertices[g];
+            unsigned int target = ~0u;
+            for(unsigned int a = adjacencyOffset[v]; a < adjacencyOffset[v + 1]; a++) {
+                for(int k = 0; k < 3; k++) {
+                    unsigned int w = indices[adjacency[a] * 3 + k];
+                    if(positionId[w] != c.to) continue;
+                    if(target != ~0u && target != w) valid = false;
+                    target = w;
+                }
+            }
+            if(target == ~0u && adjacencyOffset[v] != adjacencyOffset[v + 1]) valid = false;
+            targets.push_back(target);
+        }
+        if(!valid) continue;
+
+        // Żaden pozostały trójkąt nie może się przewrócić ani mocno zgiąć
+        const glm::vec3 &target = vertices[state.positionVertices[state.positionOffset[c.to]]].Position;
+        for(unsigned int g = state.positionOffset[c.from]; g < state.positionOffset[c.from + 1] && valid; g++) {
+            unsigned int v = state.positionVertices[g];
+            for(unsigned int a = adjacencyOffset[v]; a < adjacencyOffset[v + 1] && valid; a++) {
+                unsigned int t = adjacency[a];
+                unsigned int i0 = indices[t * 3], i1 = indices[t * 3 + 1], i2 = indices[t * 3 + 2];
+                if(positionId[i0] == c.to || positionId[i1] == c.to || positionId[i2] == c.to) continue; // ten trójkąt znika
+                glm::dvec3 p0 = vertices[i0].Position, p1 = vertices[i1].Position, p2 = vertices[i2].Position;
+                glm::dvec3 before = glm::cross(p1 - p0, p2 - p0);
+                if(i0 == v) p0 = target;
+                if(i1 == v) p1 = target;
+                if(i2 == v) p2 = target;
+                glm::dvec3 after = glm::cross(p1 - p0, p2 - p0);
+                double lengths = glm::length(before) * glm::length(after);
+                if(lengths <= 0.0 || glm::dot(before, after) < MIN_NORMAL_COS * lengths) valid = false;
+            }
+        }
+        if(!valid) continue;
+
+        for(unsigned int g = state.positionOffset[c.from]; g < state.positionOffset[c.from + 1]; g++) {
+            unsigned int v = state.positionVertices[g];
+            if(targets[g - state.positionOffset[c.from]] != ~0u) remap[v] = targets[g - state.positionOffset[c.from]];
+
+            // Cały pierścień sąsiadów zostaje do następnego przejścia
+            for(unsigned int a = adjacencyOffset[v]; a < adjacencyOffset[v + 1]; a++)
+                for(int k = 0; k < 3; k++)
+                    touched[positionId[indices[adjacency[a] * 3 + k]]] = 1;
+        }
+        touched[c.from] = touched[c.to] = 1;
+        state.quadrics[c.to].add(state.quadrics[c.from]);
+        state.error = std::max(state.error, static_cast<float>(std::sqrt(c.cost)));
+        performed++;
+    }
+    if(performed == 0) return false;
+
+    size_t out = 0;
+    for(size_t t = 0; t < triangleCount; t++) {
+        unsigned int a = remap[indices[t * 3]], b = remap[indices[t * 3 + 1]], c = remap[indices[t * 3 + 2]];
+        if(a == b || b == c || a == c) continue;
+        indices[out++] = a;
+        indices[out++] = b;
+        indices[out++] = c;
+    }
+    indices.resize(out);
+    return true;
+}
+
+inline void simplify(State &state, size_t targetTriangles, float maxError) {
+    while(state.indices.size() / 3 > targetTriangles)
+        if(!collapsePass(state, targetTriangles, maxError)) break;
+}
+
+// Dopisuje indeksy kolejnych LOD-ów za LOD0 i zwraca ich opis (LOD0 zawsze pierwszy)
+inline std::vector<MeshLod> buildLods(const std::vector<Vertex> &vertices, std::vector<unsigned int> &indices) {
+    std::vector<MeshLod> lods;
+    lods.push_back({ 0, static_cast<uint32_t>(indices.size()), 0.0f });
+    if(indices.empty()) return lods;
+
+    glm::vec3 boundsMin = vertices[indices[0]].Position, boundsMax = boundsMin;
+    for(const Vertex &vertex : vertices) {
+        boundsMin = glm::min(boundsMin, vertex.Position);
+        boundsMax = glm::max(boundsMax, vertex.Position);
+    }
+    float maxError = glm::length(boundsMax - boundsMin) * MAX_ERROR_RATIO;
+
+    size_t baseTriangles = indices.size() / 3;
+    State state = prepare(vertices, indices);
+    for(float ratio : LOD_RATIOS) {
+        size_t previous = lods.back().indexCount;
+        simplify(state, static_cast<size_t>(baseTriangles * ratio), maxError);
+        if(state.indices.empty() || state.indices.size() > previous * MIN_REDUCTION) break;
+
+        std::vector<unsigned int> lodIndices = MeshOptimizer::tipsify(state.indices, vertices.size());
+        lods.push_back({ static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(lodIndices.size()), state.error });
+        indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+    }
+    return lods;
+}
+
+} // namespace MeshSimplifier
+
+#endif
@@ -10,6 +10,12 @@
 #include <assimp/postprocess.h>
 
 #include "Mesh.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "ModelCache.h"
+#include "ObjParser.h"
+#include "OcclusionCuller.h"
+#include "TextureStreamer.h"
 #include "Shader.h"
 
 #include <string>
@@ -17,8 +23,28 @@
 #include <sstream>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <vector>
 
+// Wynik importu po stronie CPU - gotowy do wysłania na GPU (Model::uploadMesh)
+struct ModelImport {
+    std::string path;
+    std::string directory;
+
+    // Ścieżka Assimp: siatki skonwertowane do MeshData
+    std::vector<MeshData> meshData;
+
+    // Ścieżka .bin: widoki na zmapowany plik (mapowanie żyje do końca uploadu)
+    std::shared_ptr<MappedFile> mapping;
+    std::vector<ModelCache::MeshView> views;
+
+    // BVH trójkątów LOD0 każdej siatki - budowane na wątku roboczym (Model::buildTriangleBvhs)
+    std::vector<std::shared_ptr<const TriangleBvh>> triangleBvhs;
+    Aabb occluder; // pudełko wewnątrz karoserii (OcclusionCuller::buildHull)
+
+    size_t meshCount() const { return mapping ? views.size() : meshData.size(); }
+};
+
 class Model {
 public:
     std::vector<Texture> textures_loaded; // cache tekstur, żeby nie ładować tej samej 2 razy
@@ -26,9 +52,34 @@ public:
     std::string directory;
     bool gammaCorrection;
 
+    // Okluder do programowego odrzucania zasłoniętych aut; pusty, gdy model nie ma zwartego wnętrza
+    Aabb occluder;
+
+    // Gdy ustawiony, tekstury materiałów ładują się w tle (zamiast synchronicznego stbi_load)
+    static inline TextureStreamer* textureStreamer = nullptr;
+
+    // false: tekstury z .mtl pomijane (siatki bez Texture, nic nie trafia do gpuBytes)
+    static inline bool materialTextures = true;
+
+    // Reguły klasyfikacji materiałów (models/materials.txt); bez nich każda siatka to lakier
+    static inline const MaterialRules* materialRules = nullptr;
+
+    // Pusty model - siatki dochodzą przez uploadMesh (ładowanie w tle, ModelLoader)
+    Model() : gammaCorrection(false) {}
+
+    ~Model() { release(); }
+
+    // Siatki trzymają zakresy we wspólnej arenie - kopia zwolniłaby je dwa razy
+    Model(const Model&) = delete;
+    Model& operator=(const Model&) = delete;
+
     // Konstruktor: podajemy ścieżkę do pliku .obj
     Model(std::string const &path, bool gamma = false) : gammaCorrection(gamma) {
-        loadModel(path);
+        ModelImport import;
+        if(!importFile(path, import)) return;
+        buildTriangleBvhs(import);
+        for(size_t i = 0; i < import.meshCount(); i++)
+            uploadMesh(import, i);
     }
 
     // Rysowanie modelu = rysowanie wszystkich jego siatek (kół, karoserii, szyb)
@@ -37,37 +88,201 @@ public:
             meshes[i].Draw(shader);
     }
 
-private:
-    void loadModel(std::string const &path) {
+    // Oddaje geometrię i tekstury; poszatkowane areny od razu się kompaktują
+    void release() {
+        for(Mesh &mesh : meshes) mesh.release();
+        meshes.clear();
+        for(const Texture &texture : textures_loaded) {
+            if(textureStreamer) textureStreamer->release(texture.id);
+            else glDeleteTextures(1, &texture.id);
+        }
+        textures_loaded.clear();
+        GeometryArena::compactFragmented();
+    }
+
+    // Pamięć GPU: zakresy w arenach + tekstury materiałów (te, które już się wczytały)
+    size_t gpuBytes() const {
+        size_t bytes = 0;
+        for(const Mesh &mesh : meshes) bytes += mesh.gpuBytes;
+        if(textureStreamer)
+            for(const Texture &texture : textures_loaded) bytes += textureStreamer->bytes(texture.id);
+        return bytes;
+    }
+
+    // Pamięć CPU: kopie wierzchołków/indeksów trzymane przez siatki (ścieżka .bin ich nie ma)
+    size_t cpuBytes() const {
+        size_t bytes = 0;
+        for(const Mesh &mesh : meshes)
+            bytes += mesh.vertices.capacity() * sizeof(Vertex) + mesh.indices.capacity() * sizeof(unsigned int) +
+                     (mesh.triangleBvh ? mesh.triangleBvh->bytes() : 0);
+        return bytes;
+    }
+
+    // AABB całego modelu w jego przestrzeni
+    void bounds(glm::vec3 &boundsMin, glm::vec3 &boundsMax) const {
+        boundsMin = glm::vec3(0.0f);
+        boundsMax = glm::vec3(0.0f);
+        for(size_t i = 0; i < meshes.size(); i++) {
+            boundsMin = i == 0 ? meshes[i].boundsMin : glm::min(boundsMin, meshes[i].boundsMin);
+            boundsMax = i == 0 ? meshes[i].boundsMax : glm::max(boundsMax, meshes[i].boundsMax);
+        }
+    }
+
+    // Sfera otaczająca cały model: wokół środka AABB, obejmuje sfery wszystkich siatek
+    void boundingSphere(glm::vec3 &center, float &radius) const {
+        glm::vec3 boundsMin, boundsMax;
+        bounds(boundsMin, boundsMax);
+        center = (boundsMin + boundsMax) * 0.5f;
+        radius = 0.0f;
+        for(const Mesh &mesh : meshes)
+            radius = std::max(radius, glm::length(mesh.sphereCenter - center) + mesh.sphereRadius);
+        radius = std::min(radius, glm::length(boundsMax - boundsMin) * 0.5f);
+    }
+
+    // Wybór LOD każdej siatki według błędu na ekranie.
+    // projectionScale = wysokość okna w pikselach / (2 * tan(fov / 2)).
+    void selectLods(const glm::mat4 &model, const glm::vec3 &cameraPos, float projectionScale) {
+        float scale = glm::length(glm::vec3(model[0])); // auta są skalowane jednorodnie
+        for(Mesh &mesh : meshes) {
+            glm::vec3 center = glm::vec3(model * glm::vec4((mesh.boundsMin + mesh.boundsMax) * 0.5f, 1.0f));
+            float radius = glm::length(mesh.boundsMax - mesh.boundsMin) * 0.5f * scale;
+            // Odległość do sfery otaczającej - z bliska zawsze pełna siatka
+            float distance = std::max(glm::length(center - cameraPos) - radius, 0.1f);
+            mesh.selectLod(projectionScale * scale / distance);
+        }
+    }
+
+    // Wysłanie jednej zaimportowanej siatki na GPU - tylko z wątku renderującego
+    void uploadMesh(ModelImport &import, size_t i) {
+        directory = import.directory;
+
+        if(import.mapping) {
+            const ModelCache::MeshView &view = import.views[i];
+            std::vector<Texture> textures = loadMaterialTextures(view.textures);
+            meshes.push_back(Mesh(view.vertices, view.vertexCount, view.indices, view.indexCount, textures, view.materialName, view.lods));
+        } else {
+            MeshData &data = import.meshData[i];
+            // Wypiszmy to w konsoli, żebyś wiedział jakie masz nazwy!
+            std::cout << "Zaladowano siatke z materialem: " << data.materialName << std::endl;
+            std::vector<Texture> textures = loadMaterialTextures(data.textures);
+            meshes.push_back(Mesh(data.vertices, data.indices, textures, data.materialName, data.lods));
+            // Kopia jest już w Mesh i w buforze GL
+            data = MeshData();
+        }
+
+        if(i < import.triangleBvhs.size())
+            meshes.back().triangleBvh = import.triangleBvhs[i];
+        occluder = import.occluder;
+        if(materialRules)
+            meshes.back().material = materialRules->classify(MaterialRules::modelNameFor(import.path), meshes.back().materialName);
+    }
+
+    // Pieczenie offline: import .obj i zapis gotowych siatek do .bin
+    // Nie potrzebuje kontekstu OpenGL (tryb "--bake" w main)
+    static bool bake(std::string const &path) {
+        std::vector<MeshData> meshData;
+        if(!importSource(path, meshData)) return false;
+
+        std::string bakedPath = ModelCache::bakedPathFor(path);
+        if(!ModelCache::write(bakedPath, path, meshData)) {
+            std::cout << "BLAD::BAKE:: nie udalo sie zapisac " << bakedPath << std::endl;
+            return false;
+        }
+        std::cout << "Wypieczono: " << bakedPath << " (siatek: " << meshData.size() << ")" << std::endl;
+        return true;
+    }
+
+    // --- Etapy importu po stronie CPU (bez OpenGL, bezpieczne dla wątków roboczych) ---
+
+    // BVH trójkątów pełnej siatki (LOD0) do dokładnego trafienia promieniem, z nich okluder modelu
+    static void buildTriangleBvhs(ModelImport &import) {
+        import.triangleBvhs.resize(import.meshCount());
+        for(size_t i = 0; i < import.meshCount(); i++) {
+            std::shared_ptr<TriangleBvh> bvh = std::make_shared<TriangleBvh>();
+            if(import.mapping) {
+                const ModelCache::MeshView &view = import.views[i];
+                bvh->build(view.vertices, view.indices, view.lods.empty() ? view.indexCount : view.lods[0].indexCount);
+            } else {
+                const MeshData &data = import.meshData[i];
+                bvh->build(data.vertices.data(), data.indices.data(), data.lods.empty() ? data.indices.size() : data.lods[0].indexCount);
+            }
+            import.triangleBvhs[i] = bvh;
+        }
+
+        std::vector<const TriangleBvh*> hullMeshes;
+        for(const std::shared_ptr<const TriangleBvh> &bvh : import.triangleBvhs) hullMeshes.push_back(bvh.get());
+        import.occluder = OcclusionCuller::buildHull(hullMeshes);
+    }
+
+    // Cały import na jednym wątku: najpierw .bin, potem plik źródłowy
+    static bool importFile(std::string const &path, ModelImport &out) {
+        if(importBaked(path, out)) return true;
+        return importSource(path, out.meshData);
+    }
+
+    // Plik źródłowy: .obj własnym parserem (wątki pomocnicze), inne formaty i błędy przez Assimp
+    static bool importSource(std::string const &path, std::vector<MeshData> &out) {
+        if(ObjParser::isObj(path) && ObjParser::load(path, out, std::thread::hardware_concurrency())) {
+            for(MeshData &data : out)
+                optimizeMesh(data);
+            return true;
+        }
+
         Assimp::Importer importer;
+        const aiScene* scene = importScene(importer, path);
+        if(!scene) return false;
+
+        std::vector<aiMesh*> sceneMeshes;
+        collectMeshes(scene->mRootNode, scene, sceneMeshes);
+        out.clear();
+        for(aiMesh* mesh : sceneMeshes)
+            out.push_back(processMesh(mesh, scene));
+        return true;
+    }
+
+    // Szybka ścieżka: aktualny plik .bin (mmap, upload prosto z mapowania)
+    static bool importBaked(std::string const &path, ModelImport &out) {
+        out.path = path;
+        out.directory = path.substr(0, path.find_last_of('/'));
+
+        std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+        if(!file->open(ModelCache::bakedPathFor(path))) return false;
+        if(!ModelCache::read(*file, path, out.views)) {
+            std::cout << "Plik .bin nieaktualny lub uszkodzony, wczytuje .obj: " << path << std::endl;
+            out.views.clear();
+            return false;
+        }
+        out.mapping = file;
+        return true;
+    }
+
+    static const aiScene* importScene(Assimp::Importer &importer, std::string const &path) {
         // Wczytywanie z opcjami: Triangulacja (trójkąty) i FlipUV (odwrócenie tekstur)
-        const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_CalcTangentSpace);
+        // JoinIdenticalVertices - bez tego każdy narożnik ściany jest osobnym wierzchołkiem
+        const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_GenSmoothNormals | aiProcess_CalcTangentSpace);
 
         if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
             std::cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << std::endl;
-            return;
+            return nullptr;
         }
-        directory = path.substr(0, path.find_last_of('/'));
-
-        processNode(scene->mRootNode, scene);
+        return scene;
     }
 
-    void processNode(aiNode *node, const aiScene *scene) {
-        // Przetwórz wszystkie siatki w tym węźle
-        for(unsigned int i = 0; i < node->mNumMeshes; i++) {
-            aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-            meshes.push_back(processMesh(mesh, scene));
-        }
+    // Siatki w kolejności węzłów - ta sama kolejność co w pliku .bin
+    static void collectMeshes(aiNode *node, const aiScene *scene, std::vector<aiMesh*> &out) {
+        for(unsigned int i = 0; i < node->mNumMeshes; i++)
+            out.push_back(scene->mMeshes[node->mMeshes[i]]);
         // Potem zrób to samo dla dzieci (rekurencja)
         for(unsigned int i = 0; i < node->mNumChildren; i++) {
-            processNode(node->mChildren[i], scene);
+            collectMeshes(node->mChildren[i], scene, out);
         }
     }
 
-    Mesh processMesh(aiMesh *mesh, const aiScene *scene) {
-        std::vector<Vertex> vertices;
-        std::vector<unsigned int> indices;
-        std::vector<Texture> textures;
+    // Konwersja aiMesh -> dane CPU (bez OpenGL, więc działa też przy pieczeniu)
+    static MeshData processMesh(aiMesh *mesh, const aiScene *scene) {
+        MeshData data;
+        std::vector<Vertex> &vertices = data.vertices;
+        std::vector<unsigned int> &indices = data.indices;
 
         // 1. Przetwarzanie wierzchołków
         for(unsigned int i = 0; i < mesh->mNumVertices; i++) {
@@ -112,33 +327,56 @@ private:
         aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];    
 
         // 1. Diffuse maps (kolor)
-        std::vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-        textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
+        collectMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse", data.textures);
         
         // 2. Specular maps (połysk)
-        std::vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-        textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
+        collectMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular", data.textures);
 
         aiString str;
         material->Get(AI_MATKEY_NAME, str);
-        std::string matName = std::string(str.C_Str());
+        data.materialName = std::string(str.C_Str());
+
+        optimizeMesh(data);
+        return data;
+    }
 
-        // Wypiszmy to w konsoli, żebyś wiedział jakie masz nazwy!
-        std::cout << "Zaladowano siatke z materialem: " << matName << std::endl;
+    // Optymalizacja i LOD-y - wspólne dla Assimp i ObjParser
+    static void optimizeMesh(MeshData &data) {
+        std::vector<Vertex> &vertices = data.vertices;
+        std::vector<unsigned int> &indices = data.indices;
 
-        return Mesh(vertices, indices, textures, matName);
+        // 4. Optymalizacja pod cache wierzchołków / overdraw (trafia też do pliku .bin)
+        MeshOptimizer::Stats stats = MeshOptimizer::optimize(vertices, indices);
+
+        // 5. LOD-y: kolejne listy indeksów na tych samych wierzchołkach
+        data.lods = MeshSimplifier::buildLods(vertices, indices);
+        std::ostringstream report; // jedna linia naraz - siatki są optymalizowane na wielu wątkach
+        report << "Optymalizacja siatki " << data.materialName
+               << ": wierzcholki " << stats.verticesBefore << " -> " << stats.verticesAfter
+               << ", trojkaty " << stats.trianglesBefore << " -> " << stats.trianglesAfter
+               << ", ACMR " << stats.acmrBefore << " -> " << stats.acmrAfter << ", LOD";
+        for(const MeshLod &lod : data.lods) report << " " << lod.indexCount / 3;
+        report << "\n";
+        std::cout << report.str() << std::flush;
     }
 
-    std::vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, std::string typeName) {
-        std::vector<Texture> textures;
+private:
+    static void collectMaterialTextures(aiMaterial *mat, aiTextureType type, std::string typeName, std::vector<TextureRef> &out) {
         for(unsigned int i = 0; i < mat->GetTextureCount(type); i++) {
             aiString str;
             mat->GetTexture(type, i, &str);
-            
+            out.push_back({ typeName, str.C_Str() });
+        }
+    }
+
+    std::vector<Texture> loadMaterialTextures(const std::vector<TextureRef> &refs) {
+        std::vector<Texture> textures;
+        if(!materialTextures) return textures;
+        for(const TextureRef &ref : refs) {
             // Sprawdź czy tekstura była już załadowana
             bool skip = false;
             for(unsigned int j = 0; j < textures_loaded.size(); j++) {
-                if(std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0) {
+                if(textures_loaded[j].path == ref.path) {
                     textures.push_back(textures_loaded[j]);
                     skip = true; 
                     break;
@@ -146,9 +384,9 @@ private:
             }
             if(!skip) {   
                 Texture texture;
-                texture.id = TextureFromFile(str.C_Str(), this->directory);
-                texture.type = typeName;
-                texture.path = str.C_Str();
+                texture.id = TextureFromFile(ref.path.c_str(), this->directory);
+                texture.type = ref.type;
+                texture.path = ref.path;
                 textures.push_back(texture);
                 textures_loaded.push_back(texture); 
             }
@@ -161,6 +399,8 @@ private:
         std::string filename = std::string(path);
         filename = directory + '/' + filename;
 
+        if(textureStreamer) return textureStreamer->load(filename);
+
         unsigned int textureID;
         glGenTextures(1, &textureID);
 
@@ -0,0 +1,166 @@
+#ifndef MODEL_CACHE_H
+#define MODEL_CACHE_H
+
+// Wypieczony (binarny) format modelu: gotowe tablice Vertex/indeksów po
+// Triangulate/GenSmoothNormals, wczytywane przez mmap zamiast parsowania .obj.
+//
+// Układ pliku (wszystko little-endian, wyrównane do 4 bajtów):
+//   FileHeader
+//   dla każdej siatki: MeshHeader, nazwa materiału, tekstury (typ + ścieżka),
+//                      vertexCount * Vertex, indexCount * uint32 (wszystkie LOD-y), lodCount * MeshLod
+
+#include "Mesh.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <system_error>
+
+namespace ModelCache {
+
+const char     MAGIC[4] = { 'S', 'L', 'N', 'B' };
+const uint32_t VERSION  = 3; // 2: siatki po MeshOptimizer, 3: LOD-y
+
+struct FileHeader {
+    char     magic[4];
+    uint32_t version;
+    uint32_t meshCount;
+    uint32_t vertexStride; // sizeof(Vertex) - zmiana struktury unieważnia plik
+    uint64_t sourceSize;   // rozmiar .obj w chwili pieczenia
+    int64_t  sourceTime;   // czas modyfikacji .obj w chwili pieczenia
+};
+
+struct MeshHeader {
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t textureCount;
+    uint32_t lodCount;
+};
+
+// Siatka odczytana z pliku - wskaźniki pokazują wprost na zmapowaną pamięć
+struct MeshView {
+    std::string materialName;
+    std::vector<TextureRef> textures;
+    const Vertex* vertices = nullptr;
+    uint32_t vertexCount = 0;
+    const unsigned int* indices = nullptr;
+    uint32_t indexCount = 0;
+    std::vector<MeshLod> lods;
+};
+
+// models/car-1.obj -> models/car-1.bin
+inline std::string bakedPathFor(const std::string &sourcePath) {
+    size_t dot = sourcePath.find_last_of('.');
+    size_t slash = sourcePath.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return sourcePath + ".bin";
+    return sourcePath.substr(0, dot) + ".bin";
+}
+
+inline void writeString(std::ofstream &out, const std::string &str) {
+    static const char zeros[4] = { 0, 0, 0, 0 };
+    uint32_t length = static_cast<uint32_t>(str.size());
+    out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    out.write(str.data(), str.size());
+    out.write(zeros, padTo4(str.size()) - str.size());
+}
+
+inline bool write(const std::string &bakedPath, const std::string &sourcePath, const std::vector<MeshData> &meshes) {
+    FileHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.meshCount = static_cast<uint32_t>(meshes.size());
+    header.vertexStride = sizeof(Vertex);
+    if (!fileStamp(sourcePath, header.sourceSize, header.sourceTime)) return false;
+
+    // Najpierw plik tymczasowy - przerwane pieczenie nie zostawi uszkodzonego .bin
+    std::string tmpPath = bakedPath + ".tmp";
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const MeshData &mesh : meshes) {
+        MeshHeader meshHeader;
+        meshHeader.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+        meshHeader.indexCount = static_cast<uint32_t>(mesh.indices.size());
+        meshHeader.textureCount = static_cast<uint32_t>(mesh.textures.size());
+        meshHeader.lodCount = static_cast<uint32_t>(mesh.lods.size());
+        out.write(reinterpret_cast<const char*>(&meshHeader), sizeof(meshHeader));
+
+        writeString(out, mesh.materialName);
+        for (const TextureRef &texture : mesh.textures) {
+            writeString(out, texture.type);
+            writeString(out, texture.path);
+        }
+        out.write(reinterpret_cast<const char*>(mesh.vertices.data()), mesh.vertices.size() * sizeof(Vertex));
+        out.write(reinterpret_cast<const char*>(mesh.indices.data()), mesh.indices.size() * sizeof(unsigned int));
+        out.write(reinterpret_cast<const char*>(mesh.lods.data()), mesh.lods.size() * sizeof(MeshLod));
+    }
+    out.close();
+    if (!out) return false;
+
+    std::error_code ec;
+    std::filesystem::remove(bakedPath, ec);
+    std::filesystem::rename(tmpPath, bakedPath, ec);
+    return !ec;
+}
+
+// Zwraca false, gdy plik jest uszkodzony (także indeks poza siatką), w innej wersji albo starszy niż .obj
+inline bool read(const MappedFile &file, const std::string &sourcePath, std::vector<MeshView> &meshes) {
+    ByteReader reader(file.bytes(), file.length());
+    const FileHeader* header = reader.take<FileHeader>();
+    if (!header) return false;
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+    if (header->version != VERSION || header->vertexStride != sizeof(Vertex)) return false;
+
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    if (fileStamp(sourcePath, sourceSize, sourceTime) &&
+        (sourceSize != header->sourceSize || sourceTime != header->sourceTime))
+        return false; // .obj zmienił się od pieczenia
+
+    meshes.clear();
+    meshes.reserve(header->meshCount);
+    for (uint32_t i = 0; i < header->meshCount; i++) {
+        const MeshHeader* meshHeader = reader.take<MeshHeader>();
+        if (!meshHeader) return false;
+
+        MeshView view;
+        if (!reader.readString(view.materialName)) return false;
+        for (uint32_t t = 0; t < meshHeader->textureCount; t++) {
+            TextureRef texture;
+            if (!reader.readString(texture.type) || !reader.readString(texture.path)) return false;
+            view.textures.push_back(texture);
+        }
+
+        view.vertexCount = meshHeader->vertexCount;
+        view.indexCount = meshHeader->indexCount;
+        view.vertices = reader.take<Vertex>(view.vertexCount);
+        view.indices = reader.take<unsigned int>(view.indexCount);
+        if (!view.vertices || !view.indices) return false;
+        // Uszkodzony plik z pasującym znacznikiem .obj nie może wskazać wierzchołka poza siatką (odczyt poza buforem na GPU)
+        unsigned int maxIndex = 0;
+        for (uint32_t k = 0; k < view.indexCount; k++) maxIndex = std::max(maxIndex, view.indices[k]);
+        if (view.indexCount > 0 && maxIndex >= view.vertexCount) return false;
+
+        const MeshLod* lods = reader.take<MeshLod>(meshHeader->lodCount);
+        if (!lods) return false;
+        for (uint32_t l = 0; l < meshHeader->lodCount; l++) {
+            if (lods[l].firstIndex + uint64_t(lods[l].indexCount) > view.indexCount) return false;
+            view.lods.push_back(lods[l]);
+        }
+
+        meshes.push_back(view);
+    }
+    return true;
+}
+
+} // namespace ModelCache
+
+#endif
@@ -0,0 +1,206 @@
+#ifndef MODEL_LOADER_H
+#define MODEL_LOADER_H
+
+#include "Model.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Ładowanie modeli w tle:
+//  - wątki robocze: mmap .bin albo import .obj (kawałki pliku i siatki osobnymi zadaniami), Assimp dla reszty,
+//  - wątek renderujący: pump() wysyła gotowe siatki na GPU w limicie czasu na klatkę.
+class ModelLoader {
+public:
+    // Model gotowy do rysowania (wszystkie siatki na GPU); nullptr = import się nie udał
+    struct Finished {
+        int slot;
+        Model* model;
+    };
+
+    explicit ModelLoader(ThreadPool &pool) : pool(pool) {}
+
+    // Wywoływane z wątku renderującego
+    void request(int slot, const std::string &path) {
+        if(idle()) startTime = std::chrono::steady_clock::now();
+        requested++;
+        reported = false;
+
+        std::shared_ptr<Job> job = std::make_shared<Job>();
+        job->slot = slot;
+        job->path = path;
+        job->queuedAt = std::chrono::steady_clock::now();
+
+        pool.enqueue([this, job] { importJob(job); });
+    }
+
+    // Wysyła siatki na GPU, aż skończy się budżet czasu (co najmniej jedna siatka na wywołanie).
+    // Zwraca modele, które w tej klatce stały się kompletne.
+    std::vector<Finished> pump(double budgetMs) {
+        std::vector<Finished> finished;
+        auto frameStart = std::chrono::steady_clock::now();
+
+        for(;;) {
+            if(!current) {
+                std::lock_guard<std::mutex> lock(readyMutex);
+                if(ready.empty()) break;
+                current = ready.front();
+                ready.pop_front();
+            }
+
+            if(current->failed) {
+                std::cout << "Nie udalo sie wczytac modelu: " << current->path << std::endl;
+                finished.push_back({ current->slot, nullptr });
+                completeCurrent();
+                continue;
+            }
+
+            if(!current->model) current->model = new Model();
+            if(current->nextMesh < current->import.meshCount())
+                current->model->uploadMesh(current->import, current->nextMesh++);
+
+            if(current->nextMesh >= current->import.meshCount()) {
+                finished.push_back({ current->slot, current->model });
+                size_t gpuBytes = 0;
+                for(const Mesh &mesh : current->model->meshes) gpuBytes += mesh.gpuBytes;
+                std::cout << "Gotowy: " << current->path << " (" << elapsedMs(current->queuedAt) << " ms, geometria "
+                          << gpuBytes / 1024 << " KB)" << std::endl;
+                completeCurrent();
+            }
+
+            if(elapsedMs(frameStart) >= budgetMs) break;
+        }
+
+        if(requested > 0 && completed == requested && !reported) {
+            reported = true;
+            std::cout << "Wszystkie modele zaladowane w " << elapsedMs(startTime) << " ms" << std::endl;
+        }
+        return finished;
+    }
+
+    bool idle() const { return completed == requested; }
+
+private:
+    struct Job {
+        int slot = 0;
+        std::string path;
+        ModelImport import;
+        bool failed = false;
+        Model* model = nullptr;
+        size_t nextMesh = 0;
+        std::chrono::steady_clock::time_point queuedAt;
+    };
+
+    ThreadPool &pool;
+
+    std::mutex readyMutex;
+    std::deque<std::shared_ptr<Job>> ready; // zaimportowane, czekają na upload
+
+    // Tylko wątek renderujący
+    std::shared_ptr<Job> current;
+    int requested = 0;
+    int completed = 0;
+    bool reported = false;
+    std::chrono::steady_clock::time_point startTime;
+
+    static double elapsedMs(std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    }
+
+    void completeCurrent() {
+        // Zwolnienie Job zamyka mapowanie .bin i dane CPU
+        current.reset();
+        completed++;
+    }
+
+    void markReady(const std::shared_ptr<Job> &job) {
+        if(!job->failed) Model::buildTriangleBvhs(job->import);
+        std::lock_guard<std::mutex> lock(readyMutex);
+        ready.push_back(job);
+    }
+
+    // Wątek roboczy
+    void importJob(std::shared_ptr<Job> job) {
+        if(Model::importBaked(job->path, job->import)) {
+            markReady(job);
+            return;
+        }
+
+        // .obj: kawałki pliku parsowane równolegle, ostatni kawałek uruchamia składanie siatek
+        std::shared_ptr<ObjParser::ObjFile> obj = std::make_shared<ObjParser::ObjFile>();
+        if(ObjParser::isObj(job->path) && ObjParser::open(job->path, *obj, pool.size())) {
+            std::shared_ptr<std::atomic<size_t>> remaining = std::make_shared<std::atomic<size_t>>(obj->chunks.size());
+            for(size_t i = 0; i < obj->chunks.size(); i++) {
+                pool.enqueue([this, job, obj, i, remaining] {
+                    ObjParser::parseChunk(*obj, i);
+                    if(remaining->fetch_sub(1) == 1) buildObjMeshes(job, obj);
+                });
+            }
+            return;
+        }
+        importAssimp(job);
+    }
+
+    // Wątek roboczy - po sparsowaniu wszystkich kawałków
+    void buildObjMeshes(std::shared_ptr<Job> job, std::shared_ptr<ObjParser::ObjFile> obj) {
+        if(!ObjParser::resolve(*obj)) {
+            std::cout << "OBJ: bledne indeksy, wczytuje przez Assimp: " << job->path << std::endl;
+            importAssimp(job);
+            return;
+        }
+        if(obj->groups.empty()) {
+            markReady(job);
+            return;
+        }
+
+        // Każda grupa materiału osobnym zadaniem, jak siatki z Assimp
+        job->import.meshData.resize(obj->groups.size());
+        std::shared_ptr<std::atomic<size_t>> remaining = std::make_shared<std::atomic<size_t>>(obj->groups.size());
+        for(size_t i = 0; i < obj->groups.size(); i++) {
+            pool.enqueue([this, job, obj, i, remaining] {
+                job->import.meshData[i] = ObjParser::buildMesh(*obj, i);
+                Model::optimizeMesh(job->import.meshData[i]);
+                if(remaining->fetch_sub(1) == 1) markReady(job);
+            });
+        }
+    }
+
+    // Wątek roboczy - inne formaty albo plik, którego ObjParser nie przyjął
+    void importAssimp(std::shared_ptr<Job> job) {
+        // Importer musi żyć, dopóki ostatnia siatka nie zostanie skonwertowana
+        std::shared_ptr<Assimp::Importer> importer = std::make_shared<Assimp::Importer>();
+        const aiScene* scene = Model::importScene(*importer, job->path);
+        if(!scene) {
+            job->failed = true;
+            markReady(job);
+            return;
+        }
+
+        std::vector<aiMesh*> sceneMeshes;
+        Model::collectMeshes(scene->mRootNode, scene, sceneMeshes);
+        if(sceneMeshes.empty()) {
+            markReady(job);
+            return;
+        }
+
+        // Siatki jednego modelu konwertujemy równolegle; ostatnie zadanie oddaje model do uploadu.
+        // Zadania nie czekają na siebie nawzajem, więc pula się nie zakleszczy.
+        job->import.meshData.resize(sceneMeshes.size());
+        std::shared_ptr<std::atomic<size_t>> remaining = std::make_shared<std::atomic<size_t>>(sceneMeshes.size());
+        for(size_t i = 0; i < sceneMeshes.size(); i++) {
+            aiMesh* mesh = sceneMeshes[i];
+            pool.enqueue([this, job, importer, scene, mesh, i, remaining] {
+                job->import.meshData[i] = Model::processMesh(mesh, scene);
+                if(remaining->fetch_sub(1) == 1) markReady(job);
+            });
+        }
+    }
+};
+
+#endif
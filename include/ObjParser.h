@@ -0,0 +1,448 @@
+#ifndef OBJ_PARSER_H
+#define OBJ_PARSER_H
+
+// Własny parser Wavefront OBJ/MTL - szybka ścieżka zamiast Assimp dla naszych aut:
+//  1. open: mmap pliku i podział na kawałki zakończone na granicy linii,
+//  2. parseChunk: każdy kawałek parsowany niezależnie (osobny wątek / zadanie puli),
+//  3. resolve: sklejenie kawałków, indeksy względne, grupy po "usemtl", plik .mtl,
+//  4. buildMesh: wierzchołki bez powtórzeń + gładkie normalne (jak aiProcess_GenSmoothNormals).
+// Każdy etap działa bez OpenGL. Optymalizację i LOD-y robi potem Model::optimizeMesh.
+
+#include "Mesh.h"
+#include "MappedFile.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace ObjParser {
+
+// Mniejszych kawałków nie opłaca się rozdzielać między wątki
+const size_t MIN_CHUNK_BYTES = 256 * 1024;
+
+// Brak składowej w narożniku ściany (np. "f 1//3" nie ma UV)
+const int32_t MISSING = INT32_MIN;
+
+// Narożnik ściany: indeksy pozycji / UV / normalnej, od zera
+struct Corner {
+    int32_t v, t, n;
+    bool operator==(const Corner &o) const { return v == o.v && t == o.t && n == o.n; }
+};
+
+struct CornerHash {
+    size_t operator()(const Corner &c) const {
+        return static_cast<size_t>(static_cast<uint32_t>(c.v) * 73856093u ^ static_cast<uint32_t>(c.t) * 19349663u ^ static_cast<uint32_t>(c.n) * 83492791u);
+    }
+};
+
+// "usemtl" od trójkąta firstTriangle (w numeracji kawałka)
+struct MaterialRun {
+    size_t firstTriangle;
+    std::string name;
+};
+
+struct Chunk {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    std::vector<Corner> corners; // po 3 na trójkąt (wielokąty rozłożone na wachlarz)
+    std::vector<MaterialRun> materials;
+    std::vector<std::string> libraries;
+
+    // Indeksy ujemne ("-1" = ostatni wierzchołek) są liczone od początku kawałka -
+    // resolve dodaje do nich liczbę wierzchołków z wcześniejszych kawałków
+    std::vector<size_t> relativeV, relativeT, relativeN;
+};
+
+struct Group {
+    std::string material;
+    std::vector<Corner> corners;
+};
+
+struct ObjFile {
+    std::string path;
+    std::string directory;
+    MappedFile file;
+    std::vector<Chunk> chunks;
+
+    // Po resolve
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    std::vector<Group> groups;                                // w kolejności pierwszego "usemtl"
+    std::map<std::string, std::vector<TextureRef>> materials; // z plików .mtl
+};
+
+inline bool isObj(const std::string &path) {
+    if(path.size() < 4) return false;
+    std::string ext = path.substr(path.size() - 4);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".obj";
+}
+
+// --- Parsowanie liczb (bez locale i bez kopiowania do std::string) ---
+
+inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+inline const char* skipSpaces(const char* p, const char* end) {
+    while(p < end && isSpace(*p)) p++;
+    return p;
+}
+
+// Mantysa do 19 cyfr razy dokładna potęga dziesięciu - wystarczy z zapasem na float
+inline const char* parseFloat(const char* p, const char* end, float &out) {
+    static const double POWERS[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                     1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    p = skipSpaces(p, end);
+    bool negative = false;
+    if(p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+
+    uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+    for(; p < end && isDigit(*p); p++) {
+        if(digits < 19) { mantissa = mantissa * 10 + (*p - '0'); if(mantissa) digits++; }
+        else exponent++;
+    }
+    if(p < end && *p == '.') {
+        for(p++; p < end && isDigit(*p); p++) {
+            if(digits < 19) { mantissa = mantissa * 10 + (*p - '0'); if(mantissa) digits++; exponent--; }
+        }
+    }
+    if(p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negativeExp = false;
+        if(p < end && (*p == '-' || *p == '+')) negativeExp = *p++ == '-';
+        int e = 0;
+        for(; p < end && isDigit(*p); p++) e = std::min(e * 10 + (*p - '0'), 1000);
+        exponent += negativeExp ? -e : e;
+    }
+
+    double value = static_cast<double>(mantissa);
+    if(exponent < 0) value = exponent >= -22 ? value / POWERS[-exponent] : value * std::pow(10.0, exponent);
+    else if(exponent > 0) value = exponent <= 22 ? value * POWERS[exponent] : value * std::pow(10.0, exponent);
+    out = static_cast<float>(negative ? -value : value);
+    return p;
+}
+
+inline const char* parseInt(const char* p, const char* end, int32_t &out, bool &ok) {
+    bool negative = false;
+    if(p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+    ok = p < end && isDigit(*p);
+    int64_t value = 0;
+    for(; p < end && isDigit(*p); p++) value = std::min<int64_t>(value * 10 + (*p - '0'), INT32_MAX);
+    out = static_cast<int32_t>(negative ? -value : value);
+    return p;
+}
+
+// Reszta linii bez białych znaków na końcach
+inline std::string restOfLine(const char* p, const char* end) {
+    p = skipSpaces(p, end);
+    const char* lineEnd = p;
+    while(lineEnd < end && *lineEnd != '\n') lineEnd++;
+    while(lineEnd > p && isSpace(lineEnd[-1])) lineEnd--;
+    return std::string(p, lineEnd);
+}
+
+// --- Etapy ---
+
+// Mapuje plik i dzieli go na co najwyżej maxChunks kawałków
+inline bool open(const std::string &path, ObjFile &obj, size_t maxChunks) {
+    obj.path = path;
+    size_t slash = path.find_last_of("/\\");
+    obj.directory = slash == std::string::npos ? "." : path.substr(0, slash);
+    if(!obj.file.open(path)) return false;
+
+    const char* begin = reinterpret_cast<const char*>(obj.file.bytes());
+    const char* end = begin + obj.file.length();
+    size_t chunkCount = std::max<size_t>(1, std::min(maxChunks, obj.file.length() / MIN_CHUNK_BYTES));
+    size_t chunkSize = obj.file.length() / chunkCount;
+
+    obj.chunks.assign(chunkCount, Chunk());
+    const char* cursor = begin;
+    for(size_t i = 0; i < chunkCount; i++) {
+        const char* chunkEnd = i + 1 == chunkCount ? end : std::max(cursor, begin + (i + 1) * chunkSize);
+        const char* newline = static_cast<const char*>(std::memchr(chunkEnd, '\n', end - chunkEnd));
+        chunkEnd = newline ? newline + 1 : end;
+        obj.chunks[i].begin = cursor;
+        obj.chunks[i].end = chunkEnd;
+        cursor = chunkEnd;
+    }
+    return true;
+}
+
+// Indeks z pliku (od 1 albo ujemny względny) -> od 0 w numeracji kawałka
+inline bool parseIndex(const char* &p, const char* end, size_t count, int32_t &index, bool &relative) {
+    int32_t value;
+    bool ok;
+    p = parseInt(p, end, value, ok);
+    if(!ok || value == 0) return false;
+    relative = value < 0;
+    index = relative ? static_cast<int32_t>(count) + value : value - 1;
+    return true;
+}
+
+inline void parseFace(Chunk &chunk, const char* p, const char* end) {
+    const int MAX_CORNERS = 64;
+    Corner face[MAX_CORNERS];
+    bool relative[MAX_CORNERS][3] = {};
+    int count = 0;
+
+    for(;;) {
+        p = skipSpaces(p, end);
+        if(p >= end || *p == '\n' || *p == '#') break;
+
+        Corner c = { MISSING, MISSING, MISSING };
+        bool rel[3] = { false, false, false };
+        if(!parseIndex(p, end, chunk.positions.size(), c.v, rel[0])) return; // uszkodzona ściana - pomijamy
+        if(p < end && *p == '/') {
+            p++;
+            if(p < end && *p != '/' && !parseIndex(p, end, chunk.uvs.size(), c.t, rel[1])) return;
+            if(p < end && *p == '/') {
+                p++;
+                if(!parseIndex(p, end, chunk.normals.size(), c.n, rel[2])) return;
+            }
+        }
+        if(count == MAX_CORNERS) return;
+        face[count] = c;
+        std::copy(rel, rel + 3, relative[count]);
+        count++;
+    }
+
+    // Wachlarz (0, i, i+1) - jak aiProcess_Triangulate dla wielokątów wypukłych
+    for(int i = 1; i + 1 < count; i++) {
+        for(int k : { 0, i, i + 1 }) {
+            size_t corner = chunk.corners.size();
+            chunk.corners.push_back(face[k]);
+            if(relative[k][0]) chunk.relativeV.push_back(corner);
+            if(relative[k][1]) chunk.relativeT.push_back(corner);
+            if(relative[k][2]) chunk.relativeN.push_back(corner);
+        }
+    }
+}
+
+inline void parseChunk(ObjFile &obj, size_t index) {
+    Chunk &chunk = obj.chunks[index];
+    const char* p = chunk.begin;
+    const char* end = chunk.end;
+
+    while(p < end) {
+        p = skipSpaces(p, end);
+        if(p + 1 < end) {
+            if(p[0] == 'v' && isSpace(p[1])) {
+                glm::vec3 v;
+                p = parseFloat(p + 2, end, v.x);
+                p = parseFloat(p, end, v.y);
+                p = parseFloat(p, end, v.z);
+                chunk.positions.push_back(v);
+            } else if(p[0] == 'v' && p[1] == 't') {
+                glm::vec2 t;
+                p = parseFloat(p + 2, end, t.x);
+                p = parseFloat(p, end, t.y);
+                chunk.uvs.push_back(t);
+            } else if(p[0] == 'v' && p[1] == 'n') {
+                glm::vec3 n;
+                p = parseFloat(p + 2, end, n.x);
+                p = parseFloat(p, end, n.y);
+                p = parseFloat(p, end, n.z);
+                chunk.normals.push_back(n);
+            } else if(p[0] == 'f' && isSpace(p[1])) {
+                parseFace(chunk, p + 2, end);
+            } else if(end - p > 7 && std::strncmp(p, "usemtl", 6) == 0 && isSpace(p[6])) {
+                chunk.materials.push_back({ chunk.corners.size() / 3, restOfLine(p + 7, end) });
+            } else if(end - p > 7 && std::strncmp(p, "mtllib", 6) == 0 && isSpace(p[6])) {
+                chunk.libraries.push_back(restOfLine(p + 7, end));
+            }
+        }
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        p = newline ? newline + 1 : end;
+    }
+}
+
+// Tekstury materiałów: map_Kd -> texture_diffuse, map_Ks -> texture_specular (jak Model::processMesh)
+inline void parseMaterialLibrary(ObjFile &obj, const std::string &name) {
+    std::ifstream in(obj.directory + "/" + name);
+    if(!in) {
+        std::cout << "OBJ: brak biblioteki materialow " << name << std::endl;
+        return;
+    }
+    std::string line, current;
+    std::map<std::string, std::vector<TextureRef>> diffuse, specular;
+    while(std::getline(in, line)) {
+        const char* p = skipSpaces(line.data(), line.data() + line.size());
+        const char* end = line.data() + line.size();
+        std::string keyword;
+        while(p < end && !isSpace(*p)) keyword += *p++;
+        if(keyword == "newmtl") {
+            current = restOfLine(p, end);
+            obj.materials[current];
+        } else if(keyword == "map_Kd" || keyword == "map_Ks") {
+            // Opcje typu "-s 1 1 1" pomijamy - ścieżka to ostatnie słowo
+            std::string rest = restOfLine(p, end);
+            size_t space = rest.find_last_of(" \t");
+            std::string file = space == std::string::npos ? rest : rest.substr(space + 1);
+            if(keyword == "map_Kd") diffuse[current].push_back({ "texture_diffuse", file });
+            else specular[current].push_back({ "texture_specular", file });
+        }
+    }
+    for(auto &entry : obj.materials) {
+        std::vector<TextureRef> &textures = entry.second;
+        textures.insert(textures.end(), diffuse[entry.first].begin(), diffuse[entry.first].end());
+        textures.insert(textures.end(), specular[entry.first].begin(), specular[entry.first].end());
+    }
+}
+
+// Skleja kawałki; false = indeks spoza zakresu (wtedy fallback na Assimp)
+inline bool resolve(ObjFile &obj) {
+    size_t positionCount = 0, uvCount = 0, normalCount = 0;
+    for(const Chunk &chunk : obj.chunks) {
+        positionCount += chunk.positions.size();
+        uvCount += chunk.uvs.size();
+        normalCount += chunk.normals.size();
+    }
+    obj.positions.reserve(positionCount);
+    obj.uvs.reserve(uvCount);
+    obj.normals.reserve(normalCount);
+
+    std::map<std::string, size_t> groupIndex;
+    std::vector<std::string> libraries;
+    size_t current = SIZE_MAX;
+    auto useMaterial = [&](const std::string &name) {
+        auto it = groupIndex.emplace(name, obj.groups.size());
+        if(it.second) obj.groups.push_back({ name, {} });
+        current = it.first->second;
+    };
+
+    for(Chunk &chunk : obj.chunks) {
+        for(size_t c : chunk.relativeV) chunk.corners[c].v += static_cast<int32_t>(obj.positions.size());
+        for(size_t c : chunk.relativeT) chunk.corners[c].t += static_cast<int32_t>(obj.uvs.size());
+        for(size_t c : chunk.relativeN) chunk.corners[c].n += static_cast<int32_t>(obj.normals.size());
+        obj.positions.insert(obj.positions.end(), chunk.positions.begin(), chunk.positions.end());
+        obj.uvs.insert(obj.uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+        obj.normals.insert(obj.normals.end(), chunk.normals.begin(), chunk.normals.end());
+        libraries.insert(libraries.end(), chunk.libraries.begin(), chunk.libraries.end());
+
+        // Ściany przed pierwszym "usemtl" kawałka należą do materiału z poprzedniego kawałka
+        size_t triangleCount = chunk.corners.size() / 3;
+        size_t run = 0;
+        for(size_t t = 0; t < triangleCount; t++) {
+            while(run < chunk.materials.size() && chunk.materials[run].firstTriangle == t)
+                useMaterial(chunk.materials[run++].name);
+            if(current == SIZE_MAX) useMaterial("DefaultMaterial"); // nazwa jak w Assimp
+            std::vector<Corner> &corners = obj.groups[current].corners;
+            corners.insert(corners.end(), chunk.corners.begin() + t * 3, chunk.corners.begin() + t * 3 + 3);
+        }
+        while(run < chunk.materials.size()) useMaterial(chunk.materials[run++].name);
+
+        // Dane kawałka są już skopiowane
+        chunk = Chunk();
+    }
+    obj.file.close();
+
+    // Grupy bez ścian (same "usemtl") nie są siatkami
+    obj.groups.erase(std::remove_if(obj.groups.begin(), obj.groups.end(), [](const Group &g) { return g.corners.empty(); }), obj.groups.end());
+
+    for(const Group &group : obj.groups) {
+        for(const Corner &c : group.corners) {
+            if(c.v < 0 || static_cast<size_t>(c.v) >= obj.positions.size()) return false;
+            if(c.t != MISSING && (c.t < 0 || static_cast<size_t>(c.t) >= obj.uvs.size())) return false;
+            if(c.n != MISSING && (c.n < 0 || static_cast<size_t>(c.n) >= obj.normals.size())) return false;
+        }
+    }
+
+    std::sort(libraries.begin(), libraries.end());
+    libraries.erase(std::unique(libraries.begin(), libraries.end()), libraries.end());
+    for(const std::string &library : libraries)
+        parseMaterialLibrary(obj, library);
+    return true;
+}
+
+// Jedna grupa "usemtl" -> siatka (bez optymalizacji)
+inline MeshData buildMesh(const ObjFile &obj, size_t groupIndex) {
+    const Group &group = obj.groups[groupIndex];
+    MeshData data;
+    data.materialName = group.material;
+    auto material = obj.materials.find(group.material);
+    if(material != obj.materials.end()) data.textures = material->second;
+
+    // Identyczne narożniki -> jeden wierzchołek (jak aiProcess_JoinIdenticalVertices)
+    std::unordered_map<Corner, unsigned int, CornerHash> unique;
+    unique.reserve(group.corners.size());
+    std::vector<int32_t> vertexPosition; // indeks pozycji OBJ każdego wierzchołka
+    std::vector<unsigned char> missingNormal;
+    bool missingNormals = false;
+    data.indices.reserve(group.corners.size());
+    for(const Corner &c : group.corners) {
+        auto it = unique.emplace(c, static_cast<unsigned int>(data.vertices.size()));
+        if(it.second) {
+            Vertex vertex;
+            vertex.Position = obj.positions[c.v];
+            vertex.TexCoords = c.t != MISSING ? obj.uvs[c.t] : glm::vec2(0.0f);
+            vertex.Normal = c.n != MISSING ? obj.normals[c.n] : glm::vec3(0.0f);
+            missingNormal.push_back(c.n == MISSING);
+            missingNormals = missingNormals || c.n == MISSING;
+            data.vertices.push_back(vertex);
+            vertexPosition.push_back(c.v);
+        }
+        data.indices.push_back(it.first->second);
+    }
+
+    // Gładkie normalne tam, gdzie plik ich nie ma: średnia znormalizowanych normalnych
+    // ścian wokół tej samej pozycji (jak aiProcess_GenSmoothNormals)
+    if(missingNormals) {
+        std::unordered_map<int32_t, glm::vec3> smooth;
+        for(size_t i = 0; i + 2 < data.indices.size(); i += 3) {
+            const glm::vec3 &a = data.vertices[data.indices[i]].Position;
+            const glm::vec3 &b = data.vertices[data.indices[i + 1]].Position;
+            const glm::vec3 &c = data.vertices[data.indices[i + 2]].Position;
+            glm::vec3 n = glm::cross(b - a, c - a);
+            float length = glm::length(n);
+            if(length <= 0.0f) continue;
+            for(int k = 0; k < 3; k++)
+                smooth[vertexPosition[data.indices[i + k]]] += n / length;
+        }
+        for(size_t v = 0; v < data.vertices.size(); v++) {
+            if(!missingNormal[v]) continue;
+            glm::vec3 n = smooth[vertexPosition[v]];
+            float length = glm::length(n);
+            data.vertices[v].Normal = length > 0.0f ? n / length : glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+    }
+    return data;
+}
+
+// Cały import na wywołującym wątku + threadCount - 1 wątkach pomocniczych (pieczenie, benchmark)
+inline bool load(const std::string &path, std::vector<MeshData> &out, unsigned int threadCount) {
+    ObjFile obj;
+    if(!open(path, obj, std::max(1u, threadCount))) return false;
+
+    std::vector<std::thread> helpers;
+    for(size_t i = 1; i < obj.chunks.size(); i++)
+        helpers.emplace_back([&obj, i] { parseChunk(obj, i); });
+    parseChunk(obj, 0);
+    for(std::thread &helper : helpers) helper.join();
+
+    if(!resolve(obj)) return false;
+    out.clear();
+    for(size_t g = 0; g < obj.groups.size(); g++)
+        out.push_back(buildMesh(obj, g));
+    return true;
+}
+
+} // namespace ObjParser
+
+#endif
@@ -0,0 +1,304 @@
+#ifndef OCCLUSION_CULLER_H
+#define OCCLUSION_CULLER_H
+
+// Programowe odrzucanie zasłoniętych aut (bez GPU, działa też bez okna):
+//  - kilka najbliższych aut rysuje swój okluder (pudełko wewnątrz karoserii, OcclusionCuller::buildHull
+//    liczone przy imporcie) do małego bufora głębokości WIDTH x HEIGHT,
+//  - bufor jest podzielony na pasy kafli TILE x TILE; pasy rasteryzują równolegle wątek renderujący
+//    i wolne wątki puli (każdy pas ma własny fragment bufora), wiersze po 4 piksele w SSE,
+//  - po rasteryzacji każdy kafel ma maksimum głębokości (Hi-Z), więc test pudełka auta zwykle kończy się
+//    na kaflach; auto jest zasłonięte, gdy jego najbliższa głębokość leży za wszystkimi pikselami prostokąta.
+
+#include <glm/glm.hpp>
+
+#include "Bvh.h"
+#include "ThreadPool.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define OCCLUSION_CULLER_SSE 1
+#endif
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+class OcclusionCuller {
+public:
+    static constexpr int WIDTH = 256;
+    static constexpr int HEIGHT = 128;
+    static constexpr int TILE = 8;
+    static constexpr int TILES_X = WIDTH / TILE;
+    static constexpr int TILES_Y = HEIGHT / TILE; // = liczba pasów
+    static constexpr float NEAR_W = 0.1f;         // wierzchołek bliżej = trójkąt pomijany (okluder) / obiekt widoczny
+
+    // Liczniki ostatniej klatki
+    struct Stats {
+        unsigned int occluders = 0;
+        unsigned int triangles = 0;
+        unsigned int tested = 0;
+        unsigned int occluded = 0;
+        double rasterMicroseconds = 0.0;
+        double testMicroseconds = 0.0;
+    };
+
+    // pool == nullptr: wszystkie pasy na wątku wywołującym
+    explicit OcclusionCuller(ThreadPool* pool = nullptr) : pool(pool), depth(WIDTH * HEIGHT, 1.0f), tileMax(TILES_X * TILES_Y, 1.0f) {}
+
+    OcclusionCuller(const OcclusionCuller&) = delete;
+    OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+    void begin(const glm::mat4 &viewProjection) {
+        this->viewProjection = viewProjection;
+        triangles.clear();
+        frameStats = Stats();
+    }
+
+    // Pudełko w przestrzeni modelu (okluder auta albo ściana) - 12 trójkątów
+    void addOccluder(const glm::mat4 &transform, const Aabb &box) {
+        static const int FACES[12][3] = {
+            { 0, 1, 3 }, { 0, 3, 2 }, { 4, 6, 7 }, { 4, 7, 5 }, // -x, +x
+            { 0, 4, 5 }, { 0, 5, 1 }, { 2, 3, 7 }, { 2, 7, 6 }, // -y, +y
+            { 0, 2, 6 }, { 0, 6, 4 }, { 1, 5, 7 }, { 1, 7, 3 }  // -z, +z
+        };
+        glm::mat4 toClip = viewProjection * transform;
+        glm::vec4 clip[8];
+        for(int c = 0; c < 8; c++) {
+            glm::vec3 corner((c & 4) ? box.max.x : box.min.x, (c & 2) ? box.max.y : box.min.y, (c & 1) ? box.max.z : box.min.z);
+            clip[c] = toClip * glm::vec4(corner, 1.0f);
+        }
+        frameStats.occluders++;
+        for(const int* face : FACES) {
+            if(clip[face[0]].w < NEAR_W || clip[face[1]].w < NEAR_W || clip[face[2]].w < NEAR_W) continue;
+            setupTriangle(toScreen(clip[face[0]]), toScreen(clip[face[1]]), toScreen(clip[face[2]]));
+        }
+    }
+
+    void rasterize() {
+        auto start = std::chrono::steady_clock::now();
+        frameStats.triangles = static_cast<unsigned int>(triangles.size());
+
+        // Pasy kafli są rozłączne - każdy pisze tylko swoje wiersze bufora głębokości
+        if(pool) pool->parallelFor(TILES_Y, [this](int band) { rasterizeBand(band); });
+        else for(int band = 0; band < TILES_Y; band++) rasterizeBand(band);
+
+        frameStats.rasterMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Pudełko w świecie; false = na pewno zasłonięte
+    bool visible(const Aabb &bounds) {
+        auto start = std::chrono::steady_clock::now();
+        bool result = testBox(bounds);
+        frameStats.tested++;
+        frameStats.occluded += result ? 0 : 1;
+        frameStats.testMicroseconds += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    float depthAt(int x, int y) const { return depth[y * WIDTH + x]; }
+    const std::vector<float>& depthBuffer() const { return depth; }
+    const Stats& stats() const { return frameStats; }
+
+    // Okluder modelu: największe pudełko wokół środka AABB, którego każda ściana leży za powierzchnią
+    // widzianą z zewnątrz wzdłuż osi (promienie na siatce GRID x GRID z każdej strony). Najpierw skala
+    // całego pudełka, potem każda ściana osobno. Puste (valid() == false), gdy model nie ma wnętrza.
+    static Aabb buildHull(const std::vector<const TriangleBvh*> &meshes) {
+        Aabb bounds;
+        for(const TriangleBvh* mesh : meshes)
+            if(mesh->triangleCount() > 0) bounds.grow(mesh->bounds());
+        if(!bounds.valid()) return Aabb();
+
+        glm::vec3 center = bounds.center();
+        glm::vec3 half = (bounds.max - bounds.min) * 0.5f;
+        auto scaled = [&](float scale) {
+            Aabb box;
+            box.min = center - half * scale;
+            box.max = center + half * scale;
+            return box;
+        };
+
+        float lo = 0.0f, hi = 1.0f;
+        for(int step = 0; step < 10; step++) {
+            float scale = (lo + hi) * 0.5f;
+            if(hullValid(meshes, bounds, scaled(scale))) lo = scale;
+            else hi = scale;
+        }
+        if(lo == 0.0f) return Aabb();
+        Aabb hull = scaled(lo);
+
+        for(int axis = 0; axis < 3; axis++) {
+            for(int side = 0; side < 2; side++) {
+                float &face = side ? hull.max[axis] : hull.min[axis];
+                float inner = face, outer = side ? bounds.max[axis] : bounds.min[axis];
+                for(int step = 0; step < 6; step++) {
+                    face = (inner + outer) * 0.5f;
+                    if(hullValid(meshes, bounds, hull)) inner = face;
+                    else outer = face;
+                }
+                face = inner;
+            }
+        }
+        return hull;
+    }
+
+private:
+    // Krawędzie E_i = a*x + b*y + c (>= 0 w środku), głębokość z = a*x + b*y + c
+    struct Triangle {
+        float edgeA[3], edgeB[3], edgeC[3];
+        float depthA, depthB, depthC;
+        int minX, maxX, minY, maxY;
+    };
+
+    static constexpr int GRID = 5;
+
+    ThreadPool* pool;
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+    std::vector<Triangle> triangles;
+    std::vector<float> depth;
+    std::vector<float> tileMax;
+    Stats frameStats;
+
+    static glm::vec3 toScreen(const glm::vec4 &clip) {
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        return glm::vec3((ndc.x * 0.5f + 0.5f) * WIDTH, (ndc.y * 0.5f + 0.5f) * HEIGHT, ndc.z * 0.5f + 0.5f);
+    }
+
+    void setupTriangle(const glm::vec3 &v0, const glm::vec3 &v1, const glm::vec3 &v2) {
+        float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+        if(std::abs(area) < 1e-6f) return;
+
+        Triangle t;
+        t.minX = std::max(0, static_cast<int>(std::floor(std::min({ v0.x, v1.x, v2.x })))) & ~3;
+        t.maxX = std::min(WIDTH - 1, static_cast<int>(std::ceil(std::max({ v0.x, v1.x, v2.x }))));
+        t.minY = std::max(0, static_cast<int>(std::floor(std::min({ v0.y, v1.y, v2.y }))));
+        t.maxY = std::min(HEIGHT - 1, static_cast<int>(std::ceil(std::max({ v0.y, v1.y, v2.y }))));
+        if(t.minX > t.maxX || t.minY > t.maxY) return;
+
+        // Znak pola ustala orientację - obie strony ścian rysujemy tak samo
+        float sign = area > 0.0f ? -1.0f : 1.0f;
+        const glm::vec3* v[3] = { &v0, &v1, &v2 };
+        for(int e = 0; e < 3; e++) {
+            const glm::vec3 &a = *v[e], &b = *v[(e + 1) % 3];
+            t.edgeA[e] = sign * (b.y - a.y);
+            t.edgeB[e] = sign * -(b.x - a.x);
+            t.edgeC[e] = sign * ((b.x - a.x) * a.y - (b.y - a.y) * a.x);
+        }
+        t.depthA = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+        t.depthB = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+        t.depthC = v0.z - t.depthA * v0.x - t.depthB * v0.y;
+        triangles.push_back(t);
+    }
+
+    void rasterizeBand(int band) {
+        int bandMinY = band * TILE, bandMaxY = bandMinY + TILE - 1;
+        std::fill(depth.begin() + bandMinY * WIDTH, depth.begin() + (bandMaxY + 1) * WIDTH, 1.0f);
+
+        for(const Triangle &t : triangles) {
+            int minY = std::max(t.minY, bandMinY), maxY = std::min(t.maxY, bandMaxY);
+            for(int y = minY; y <= maxY; y++) {
+                float py = y + 0.5f;
+                float* row = &depth[y * WIDTH];
+#ifdef OCCLUSION_CULLER_SSE
+                __m128 e[3], step[3];
+                __m128 px = _mm_add_ps(_mm_set1_ps(t.minX + 0.5f), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+                for(int k = 0; k < 3; k++) {
+                    e[k] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.edgeA[k]), px), _mm_set1_ps(t.edgeB[k] * py + t.edgeC[k]));
+                    step[k] = _mm_set1_ps(t.edgeA[k] * 4.0f);
+                }
+                __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.depthA), px), _mm_set1_ps(t.depthB * py + t.depthC));
+                __m128 zStep = _mm_set1_ps(t.depthA * 4.0f);
+                const __m128 zero = _mm_setzero_ps();
+                for(int x = t.minX; x <= t.maxX; x += 4) {
+                    __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e[0], zero), _mm_cmpge_ps(e[1], zero)), _mm_cmpge_ps(e[2], zero));
+                    if(_mm_movemask_ps(inside)) {
+                        __m128 current = _mm_loadu_ps(row + x);
+                        __m128 nearer = _mm_min_ps(current, z);
+                        _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, current)));
+                    }
+                    for(int k = 0; k < 3; k++) e[k] = _mm_add_ps(e[k], step[k]);
+                    z = _mm_add_ps(z, zStep);
+                }
+#else
+                for(int x = t.minX; x <= t.maxX; x++) {
+                    float px = x + 0.5f;
+                    bool inside = true;
+                    for(int k = 0; k < 3; k++) inside = inside && t.edgeA[k] * px + t.edgeB[k] * py + t.edgeC[k] >= 0.0f;
+                    if(inside) row[x] = std::min(row[x], t.depthA * px + t.depthB * py + t.depthC);
+                }
+#endif
+            }
+        }
+
+        // Hi-Z: najdalsza głębokość każdego kafla pasa
+        for(int tileX = 0; tileX < TILES_X; tileX++) {
+            float farthest = 0.0f;
+            for(int y = bandMinY; y <= bandMaxY; y++)
+                for(int x = tileX * TILE; x < (tileX + 1) * TILE; x++) farthest = std::max(farthest, depth[y * WIDTH + x]);
+            tileMax[band * TILES_X + tileX] = farthest;
+        }
+    }
+
+    bool testBox(const Aabb &bounds) const {
+        float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX, nearest = FLT_MAX;
+        for(int c = 0; c < 8; c++) {
+            glm::vec3 corner((c & 4) ? bounds.max.x : bounds.min.x, (c & 2) ? bounds.max.y : bounds.min.y, (c & 1) ? bounds.max.z : bounds.min.z);
+            glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+            if(clip.w < NEAR_W) return true; // przecina płaszczyznę kamery
+            glm::vec3 screen = toScreen(clip);
+            minX = std::min(minX, screen.x); maxX = std::max(maxX, screen.x);
+            minY = std::min(minY, screen.y); maxY = std::max(maxY, screen.y);
+            nearest = std::min(nearest, screen.z);
+        }
+        int x0 = std::max(0, static_cast<int>(std::floor(minX))), x1 = std::min(WIDTH - 1, static_cast<int>(std::floor(maxX)));
+        int y0 = std::max(0, static_cast<int>(std::floor(minY))), y1 = std::min(HEIGHT - 1, static_cast<int>(std::floor(maxY)));
+        if(x0 > x1 || y0 > y1) return true; // poza buforem - decyduje frustum
+
+        for(int tileY = y0 / TILE; tileY <= y1 / TILE; tileY++) {
+            for(int tileX = x0 / TILE; tileX <= x1 / TILE; tileX++) {
+                if(tileMax[tileY * TILES_X + tileX] < nearest) continue; // cały kafel przed obiektem
+                int px0 = std::max(x0, tileX * TILE), px1 = std::min(x1, tileX * TILE + TILE - 1);
+                int py0 = std::max(y0, tileY * TILE), py1 = std::min(y1, tileY * TILE + TILE - 1);
+                for(int y = py0; y <= py1; y++)
+                    for(int x = px0; x <= px1; x++)
+                        if(depth[y * WIDTH + x] >= nearest) return true;
+            }
+        }
+        return false;
+    }
+
+    static float castRay(const std::vector<const TriangleBvh*> &meshes, const glm::vec3 &origin, const glm::vec3 &direction) {
+        float best = FLT_MAX;
+        for(const TriangleBvh* mesh : meshes) best = std::min(best, mesh->raycast(origin, direction));
+        return best;
+    }
+
+    // Każdy promień z zewnątrz (wzdłuż osi, przez ścianę pudełka) musi trafić w model przed tą ścianą
+    static bool hullValid(const std::vector<const TriangleBvh*> &meshes, const Aabb &bounds, const Aabb &box) {
+        float margin = glm::length(bounds.max - bounds.min) * 0.01f + 1e-4f;
+        for(int axis = 0; axis < 3; axis++) {
+            int u = (axis + 1) % 3, v = (axis + 2) % 3;
+            for(int side = 0; side < 2; side++) {
+                float sign = side ? 1.0f : -1.0f;
+                glm::vec3 direction(0.0f);
+                direction[axis] = -sign;
+                for(int i = 0; i < GRID; i++) {
+                    for(int j = 0; j < GRID; j++) {
+                        glm::vec3 origin;
+                        origin[axis] = side ? bounds.max[axis] + margin : bounds.min[axis] - margin;
+                        origin[u] = box.min[u] + (box.max[u] - box.min[u]) * (i + 0.5f) / GRID;
+                        origin[v] = box.min[v] + (box.max[v] - box.min[v]) * (j + 0.5f) / GRID;
+                        float t = castRay(meshes, origin, direction);
+                        if(t == FLT_MAX) return false;
+                        float hit = origin[axis] - sign * t;
+                        if(side ? hit < box.max[axis] : hit > box.min[axis]) return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+// Zlinkowane programy z dysku (glGetProgramBinary / glProgramBinary) zamiast kompilacji źródeł przy
+// każdym starcie. Klucz = FNV-1a 64 z pełnych źródeł (z wstrzykniętymi "#define" wariantu) oraz
+// napisów GL_VENDOR / GL_RENDERER / GL_VERSION - nowy sterownik albo inna karta to inny plik.
+// Sterownik może mimo to odrzucić binarkę (GL_LINK_STATUS == 0) - wtedy Shader kompiluje ze źródeł.
+//
+// shaders/cache/<klucz>.bin: FileHeader + binarka programu
+
+#include "GLExtensions.h"
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace ProgramCache {
+
+const char     MAGIC[4] = { 'S', 'L', 'N', 'P' };
+const uint32_t VERSION  = 1;
+const char     DIRECTORY[] = "shaders/cache";
+
+struct FileHeader {
+    char     magic[4];
+    uint32_t version;
+    uint64_t key;          // powtórzony w nazwie pliku - chroni przed kolizją przy skróconej nazwie
+    uint32_t binaryFormat; // format zwrócony przez glGetProgramBinary
+    uint32_t length;
+};
+
+// Włączane przez init() przy starcie; "--no-shader-cache" zostawia kompilację ze źródeł
+inline bool enabled = false;
+
+inline uint64_t hashBytes(uint64_t h, const void* data, size_t length) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for(size_t i = 0; i < length; i++) h = (h ^ bytes[i]) * 1099511628211ull;
+    return h;
+}
+
+// Wymaga kontekstu GL: funkcje binarek + co najmniej jeden format u sterownika
+inline bool init() {
+    enabled = loadProgramBinary();
+    return enabled;
+}
+
+inline uint64_t keyFor(const std::string &vertexCode, const std::string &fragmentCode) {
+    static uint64_t driver = 0;
+    if(driver == 0) {
+        driver = 14695981039346656037ull;
+        for(GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+            const char* text = reinterpret_cast<const char*>(glGetString(name));
+            if(text) driver = hashBytes(driver, text, std::strlen(text) + 1); // z zerem - granica między napisami
+        }
+    }
+    uint64_t key = hashBytes(driver, vertexCode.c_str(), vertexCode.size() + 1);
+    return hashBytes(key, fragmentCode.c_str(), fragmentCode.size() + 1);
+}
+
+inline std::string pathFor(uint64_t key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return std::string(DIRECTORY) + "/" + name;
+}
+
+// true = program zlinkowany z binarki; false = brak pliku albo sterownik go odrzucił (plik usuwany)
+inline bool load(GLuint program, uint64_t key) {
+    if(!enabled) return false;
+    std::string path = pathFor(key);
+    MappedFile file;
+    if(!file.open(path)) return false;
+
+    ByteReader reader(file.bytes(), file.length());
+    const FileHeader* header = reader.take<FileHeader>();
+    bool valid = header && std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 && header->version == VERSION &&
+                 header->key == key && header->length == file.length() - sizeof(FileHeader);
+    GLint linked = 0;
+    if(valid) {
+        glProgramBinaryProc(program, header->binaryFormat, file.bytes() + sizeof(FileHeader), static_cast<GLsizei>(header->length));
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    }
+    file.close();
+    if(!linked) {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+    return linked != 0;
+}
+
+// Przed glLinkProgram - część sterowników zwraca binarkę tylko z tą wskazówką
+inline void markRetrievable(GLuint program) {
+    if(enabled) glProgramParameteriProc(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+// Po udanym linkowaniu; najpierw plik tymczasowy - przerwany zapis nie zostawi uszkodzonej binarki
+inline bool store(GLuint program, uint64_t key) {
+    if(!enabled) return false;
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if(length <= 0) return false;
+
+    std::vector<char> binary(length);
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinaryProc(program, length, &written, &format, binary.data());
+    if(written <= 0) return false;
+
+    FileHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.key = key;
+    header.binaryFormat = format;
+    header.length = static_cast<uint32_t>(written);
+
+    std::error_code ec;
+    std::filesystem::create_directories(DIRECTORY, ec);
+    std::string path = pathFor(key);
+    std::string tmpPath = path + ".tmp";
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if(!out) return false;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(binary.data(), written);
+    out.close();
+    if(!out) return false;
+
+    std::filesystem::remove(path, ec);
+    std::filesystem::rename(tmpPath, path, ec);
+    return !ec;
+}
+
+// Usuwa wszystkie binarki (pomiar zimnego startu)
+inline void clear() {
+    std::error_code ec;
+    std::filesystem::remove_all(DIRECTORY, ec);
+}
+
+} // namespace ProgramCache
+
+#endif
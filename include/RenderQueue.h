@@ -0,0 +1,212 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+// Kolejka rysowania: scena wrzuca elementy z 64-bitowym kluczem, kolejka sortuje je
+// pozycyjnie (radix sort po bajtach) i wysyła, zmieniając stan GL tylko przy zmianie pola klucza.
+//
+// Klucz (od najstarszego bitu):  przebieg 4 | program 8 | zarezerwowane 16 | VAO 11 | indeksy 32-bit 1 | głębokość 24
+// Głębokość to odległość od kamery skwantowana do 24 bitów - nieprzezroczyste od najbliższych.
+// Tekstur kolejka nie zmienia - wszystkie siedzą w tablicach TextureLibrary, przypiętych raz na klatkę.
+//
+// Wysyłanie: GL 3.3 - wywołanie na element (DrawData z pierścienia UBO), GL 4.3 - każdy ciąg elementów
+// o tym samym programie/VAO/typie indeksów jako jedno glMultiDrawElementsIndirect.
+
+#include <glad/glad.h>
+
+#include "GeometryArena.h"
+#include "IndirectDraw.h"
+#include "InstanceBuffer.h"
+#include "Mesh.h"
+#include "Shader.h"
+#include "UniformBuffers.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+class RenderQueue {
+public:
+    enum class Pass : uint8_t { Opaque = 0, Transparent = 1 };
+
+    struct Item {
+        uint64_t key;
+        Mesh* mesh;
+        Shader* shader;
+        size_t draw;       // numer w drawData
+        size_t firstInstance;
+        unsigned int instanceCount; // 0 = zwykłe rysowanie bez instancji
+    };
+
+    // Liczniki ostatniej wysłanej klatki
+    struct Stats {
+        unsigned int drawCalls = 0;        // glDraw* / glMultiDraw*
+        unsigned int indirectCommands = 0; // komendy w wywołaniach glMultiDrawElementsIndirect
+        unsigned int programBinds = 0;
+        unsigned int vertexArrayBinds = 0;
+        unsigned int uniformRangeBinds = 0;
+        unsigned int instanceBinds = 0;   // przestawienie atrybutów instancji na kolejną partię
+        unsigned int instances = 0;
+        unsigned int stateChanges() const { return programBinds + vertexArrayBinds + uniformRangeBinds + instanceBinds; }
+    };
+
+    static constexpr float MAX_DEPTH = 100.0f; // daleka płaszczyzna projekcji
+
+    // Wyłączane klawiszem - wysyłanie w kolejności sceny, do porównania liczników
+    static inline bool sorting = true;
+
+    static uint64_t makeKey(Pass pass, GLuint program, GLuint vertexArray, GLenum indexType, float depth) {
+        float normalized = std::min(std::max(depth / MAX_DEPTH, 0.0f), 1.0f);
+        uint64_t depthBits = static_cast<uint64_t>(normalized * 0xFFFFFF);
+        return (static_cast<uint64_t>(pass) & 0xF) << 60 |
+               (static_cast<uint64_t>(program) & 0xFF) << 52 |
+               (static_cast<uint64_t>(vertexArray) & 0x7FF) << 25 |
+               static_cast<uint64_t>(indexType == GL_UNSIGNED_INT) << 24 |
+               depthBits;
+    }
+
+    void push(Pass pass, Mesh* mesh, Shader* shader, const DrawUniforms &uniforms, float depth,
+              size_t firstInstance = 0, unsigned int instanceCount = 0) {
+        Item item;
+        item.key = makeKey(pass, shader->ID, mesh->arena->vertexArray(), mesh->indexType, depth);
+        item.mesh = mesh;
+        item.shader = shader;
+        item.draw = drawData.size();
+        item.firstInstance = firstInstance;
+        item.instanceCount = instanceCount;
+        items.push_back(item);
+        drawData.push_back(uniforms);
+    }
+
+    // Sortowanie + wysłanie; po nim kolejka jest pusta. Stan GL sprzed wywołania traktujemy jako nieznany.
+    // indirect != nullptr: ścieżka GL 4.3 - programy elementów muszą czytać dane z SSBO (shader_mdi.vert)
+    void submit(UniformBuffers &uniformBuffers, const InstanceBuffer &instanceBuffer, IndirectBuffers* indirect = nullptr) {
+        if(sorting) radixSort();
+
+        frameStats = Stats();
+        currentProgram = 0;
+
+        if(indirect) submitIndirect(*indirect, instanceBuffer);
+        else submitDirect(uniformBuffers, instanceBuffer);
+
+        items.clear();
+        drawData.clear();
+    }
+
+    const Stats& stats() const { return frameStats; }
+
+private:
+    std::vector<Item> items;
+    std::vector<Item> scratch;
+    std::vector<DrawUniforms> drawData;
+    Stats frameStats;
+
+    GLuint currentProgram = 0;
+
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<DrawRecord> records;
+
+    void bindState(const Item &item) {
+        if(currentProgram == 0 || item.shader->ID != currentProgram) {
+            item.shader->use();
+            currentProgram = item.shader->ID;
+            frameStats.programBinds++;
+        }
+        if(GeometryArena::bindVertexArray(item.mesh->arena->vertexArray()))
+            frameStats.vertexArrayBinds++;
+    }
+
+    void submitDirect(UniformBuffers &uniformBuffers, const InstanceBuffer &instanceBuffer) {
+        // DrawData w kolejności wysyłania - jedno mapowanie pierścienia na klatkę
+        for(const Item &item : items)
+            uniformBuffers.push(drawData[item.draw]);
+        uniformBuffers.upload();
+
+        for(size_t i = 0; i < items.size(); i++) {
+            const Item &item = items[i];
+            bindState(item);
+            // Dane rysowania są różne dla każdego elementu - tu zmiana jest zawsze
+            uniformBuffers.bindDraw(i);
+            frameStats.uniformRangeBinds++;
+
+            if(item.instanceCount > 0) {
+                if(item.mesh->arena->bindInstances(instanceBuffer.id(), InstanceBuffer::offsetOf(item.firstInstance)))
+                    frameStats.instanceBinds++;
+                item.mesh->drawElementsInstanced(item.instanceCount);
+                frameStats.instances += item.instanceCount;
+            } else {
+                item.mesh->drawElements();
+            }
+            frameStats.drawCalls++;
+        }
+    }
+
+    // Komendy i rekordy w kolejności po sortowaniu; baseInstance komendy = numer rekordu
+    void submitIndirect(IndirectBuffers &indirect, const InstanceBuffer &instanceBuffer) {
+        commands.clear();
+        records.clear();
+        for(size_t i = 0; i < items.size(); i++) {
+            const Item &item = items[i];
+            commands.push_back(item.mesh->indirectCommand(std::max(item.instanceCount, 1u), static_cast<unsigned int>(i)));
+            DrawRecord record = {};
+            record.uniforms = drawData[item.draw];
+            record.firstInstance = static_cast<uint32_t>(item.firstInstance);
+            records.push_back(record);
+            frameStats.instances += item.instanceCount;
+        }
+        indirect.upload(commands, records);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, IndirectBuffers::INSTANCE_BINDING, instanceBuffer.id());
+
+        size_t runStart = 0;
+        while(runStart < items.size()) {
+            const Item &first = items[runStart];
+            size_t runEnd = runStart + 1;
+            while(runEnd < items.size() && sameState(first, items[runEnd])) runEnd++;
+
+            bindState(first);
+            first.mesh->arena->bindDrawIds(indirect.drawIds(), IndirectBuffers::DRAW_ID_DIVISOR);
+            glMultiDrawElementsIndirectProc(GL_TRIANGLES, first.mesh->indexType,
+                                            (void*)(runStart * sizeof(DrawElementsIndirectCommand)),
+                                            static_cast<GLsizei>(runEnd - runStart), 0);
+            frameStats.drawCalls++;
+            frameStats.indirectCommands += static_cast<unsigned int>(runEnd - runStart);
+            runStart = runEnd;
+        }
+    }
+
+    static bool sameState(const Item &a, const Item &b) {
+        return a.shader->ID == b.shader->ID &&
+               a.mesh->arena->vertexArray() == b.mesh->arena->vertexArray() && a.mesh->indexType == b.mesh->indexType;
+    }
+
+    // LSD radix sort po bajtach klucza; bajty wspólne dla wszystkich kluczy są pomijane
+    void radixSort() {
+        if(items.size() < 2) return;
+        scratch.resize(items.size());
+
+        uint64_t allAnd = ~0ull, allOr = 0;
+        for(const Item &item : items) {
+            allAnd &= item.key;
+            allOr |= item.key;
+        }
+        uint64_t differing = allAnd ^ allOr;
+
+        for(int shift = 0; shift < 64; shift += 8) {
+            if(((differing >> shift) & 0xFF) == 0) continue;
+
+            size_t offsets[256] = {};
+            for(const Item &item : items)
+                offsets[(item.key >> shift) & 0xFF]++;
+            size_t sum = 0;
+            for(size_t &offset : offsets) {
+                size_t count = offset;
+                offset = sum;
+                sum += count;
+            }
+            for(const Item &item : items)
+                scratch[offsets[(item.key >> shift) & 0xFF]++] = item;
+            items.swap(scratch);
+        }
+    }
+};
+
+#endif
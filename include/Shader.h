@@ -4,17 +4,55 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include "ProgramCache.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
+#include <vector>
+
+// Nazwa uniformu z haszem FNV-1a. Jako "static constexpr" hasz liczy się w czasie kompilacji,
+// więc wyszukanie uniformu w pętli rysującej nie tworzy std::string.
+struct UniformName {
+    uint32_t hash;
+    const char* text;
+
+    constexpr UniformName(const char* name) : hash(hashOf(name)), text(name) {}
+    UniformName(const std::string &name) : hash(hashOf(name.c_str())), text(name.c_str()) {}
+
+    static constexpr uint32_t hashOf(const char* name) {
+        uint32_t h = 2166136261u;
+        while(*name) h = (h ^ static_cast<uint8_t>(*name++)) * 16777619u;
+        return h;
+    }
+};
 
 class Shader {
 public:
     unsigned int ID; // ID programu shaderowego
+    double buildMilliseconds = 0.0; // od zlecenia do gotowego programu (kompilacja + linkowanie albo odczyt binarki)
+    bool fromBinaryCache = false;   // program z ProgramCache (bez kompilacji źródeł)
+
+    // Uchwyt do uniformu: indeks w tabeli odczytanej z programu po zlinkowaniu.
+    // Nieistniejący uniform (np. wycięty przez kompilator) daje pusty uchwyt - ustawianie go nic nie robi.
+    struct Uniform {
+        int index = -1;
+        bool valid() const { return index >= 0; }
+    };
+
+    // Liczniki dla wszystkich programów: w stałym stanie locationQueries nie rośnie
+    static inline uint64_t locationQueries = 0; // wywołania glGetUniformLocation
+    static inline uint64_t uniformUploads = 0;  // wysłane glUniform*
+    static inline uint64_t skippedUploads = 0;  // pominięte, bo wartość się nie zmieniła
 
-    // Konstruktor: wczytuje i buduje shadery
-    Shader(const char* vertexPath, const char* fragmentPath) {
+    // Konstruktor: wczytuje i buduje shadery; "defines" trafiają do obu źródeł zaraz za "#version" (ShaderVariants).
+    // deferred = tylko zleca kompilację - program nadaje się do użycia dopiero, gdy ready() zwróci true
+    Shader(const char* vertexPath, const char* fragmentPath, const std::string &defines = "", bool deferred = false) {
         // 1. Pobierz kod źródłowy z plików
         std::string vertexCode;
         std::string fragmentCode;
@@ -40,66 +78,205 @@ public:
             fShaderFile.close();
             
             // Konwertuj strumienie na string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
+            vertexCode = withDefines(vShaderStream.str(), defines);
+            fragmentCode = withDefines(fShaderStream.str(), defines);
         }
         catch (std::ifstream::failure& e) {
             std::cout << "BLAD::SHADER::NIE_UDALO_SIE_ODCZYTAC_PLIKU: " << e.what() << std::endl;
         }
 
-        const char* vShaderCode = vertexCode.c_str();
-        const char * fShaderCode = fragmentCode.c_str();
+        submitted = std::chrono::steady_clock::now();
+        ID = glCreateProgram();
+
+        // 2. Zlinkowany program z dysku (ten sam sterownik i te same źródła), w przeciwnym razie kompilacja
+        cacheKey = ProgramCache::enabled ? ProgramCache::keyFor(vertexCode, fragmentCode) : 0;
+        fromBinaryCache = ProgramCache::enabled && ProgramCache::load(ID, cacheKey);
+        if(!fromBinaryCache) compile(vertexCode.c_str(), fragmentCode.c_str());
+        if(!deferred) wait();
+    }
+
+    // Bez blokowania: z KHR_parallel_shader_compile pyta o GL_COMPLETION_STATUS_KHR, bez niego kończy od razu
+    bool ready() {
+        if(finished) return true;
+        if(parallelShaderCompile) {
+            GLint done = 0;
+            glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &done);
+            if(!done) return false;
+        }
+        finish();
+        return true;
+    }
+
+    // Czeka na koniec kompilacji (pierwsze zapytanie o stan blokuje)
+    void wait() {
+        if(!finished) finish();
+    }
 
-        // 2. Kompiluj shadery
-        unsigned int vertex, fragment;
-        
+    ~Shader() { glDeleteProgram(ID); }
+
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+
+    // Aktywacja shadera
+    void use() { 
+        glUseProgram(ID); 
+    }
+
+    // Blok uniformów (UBO) -> punkt wiązania; GLSL 3.30 nie ma layout(binding = N)
+    void bindUniformBlock(const char* name, GLuint binding) {
+        GLuint index = glGetUniformBlockIndex(ID, name);
+        if(index != GL_INVALID_INDEX) glUniformBlockBinding(ID, index, binding);
+    }
+
+    // Rozwiązanie nazwy raz (np. przy starcie), potem set* z uchwytem
+    Uniform uniform(const UniformName &name) const {
+        auto it = lookup.find(name.hash);
+        if(it == lookup.end() || uniforms[it->second].name != name.text) return Uniform();
+        return Uniform{ it->second };
+    }
+
+    // Funkcje pomocnicze do ustawiania uniformów (wartość jest wysyłana tylko, gdy się zmieniła)
+    void setBool(Uniform u, bool value) { setInt(u, (int)value); }
+    void setInt(Uniform u, int value) {
+        if(store(u, &value, sizeof(value))) glUniform1i(uniforms[u.index].location, value);
+    }
+    void setFloat(Uniform u, float value) {
+        if(store(u, &value, sizeof(value))) glUniform1f(uniforms[u.index].location, value);
+    }
+    void setVec3(Uniform u, float x, float y, float z) {
+        float value[3] = { x, y, z };
+        if(store(u, value, sizeof(value))) glUniform3f(uniforms[u.index].location, x, y, z);
+    }
+    void setMat4(Uniform u, const glm::mat4 &mat) {
+        if(store(u, &mat[0][0], sizeof(mat))) glUniformMatrix4fv(uniforms[u.index].location, 1, GL_FALSE, &mat[0][0]);
+    }
+
+    // Wersje z nazwą - wyszukanie w tabeli (bez glGetUniformLocation)
+    void setBool(const UniformName &name, bool value) { setBool(uniform(name), value); }
+    void setInt(const UniformName &name, int value) { setInt(uniform(name), value); }
+    void setFloat(const UniformName &name, float value) { setFloat(uniform(name), value); }
+    void setVec3(const UniformName &name, float x, float y, float z) { setVec3(uniform(name), x, y, z); }
+    void setMat4(const UniformName &name, const glm::mat4 &mat) { setMat4(uniform(name), mat); }
+
+private:
+    struct UniformSlot {
+        std::string name;
+        GLint location;
+        unsigned char value[sizeof(glm::mat4)]; // ostatnio wysłana wartość
+        bool known = false;                     // przed pierwszym wysłaniem wartość w programie jest nieznana
+    };
+    std::vector<UniformSlot> uniforms;
+    std::unordered_map<uint32_t, int> lookup; // hasz nazwy -> indeks w uniforms
+
+    // Po zlinkowaniu: wszystkie aktywne uniformy (tablice element po elemencie) do tabeli lokalizacji
+    void reflectUniforms() {
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<char> buffer(maxLength + 1);
+
+        for(GLint i = 0; i < count; i++) {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(ID, i, (GLsizei)buffer.size(), &length, &size, &type, buffer.data());
+            std::string name(buffer.data(), length);
+
+            // Tablica "lights[0]": rejestrujemy "lights" oraz każdy element "lights[k]"
+            bool isArray = name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0;
+            std::string base = isArray ? name.substr(0, name.size() - 3) : name;
+            for(GLint k = 0; k < size; k++) {
+                std::string element = isArray ? base + "[" + std::to_string(k) + "]" : base;
+                addUniform(element);
+                if(isArray && k == 0) addUniform(base);
+            }
+        }
+    }
+
+    void addUniform(const std::string &name) {
+        locationQueries++;
+        GLint location = glGetUniformLocation(ID, name.c_str());
+        if(location < 0) return; // uniform w bloku (UBO) nie ma lokalizacji
+
+        uint32_t hash = UniformName::hashOf(name.c_str());
+        if(lookup.count(hash)) {
+            std::cout << "BLAD::SHADER::KOLIZJA_HASZA_UNIFORMU: " << name << " i " << uniforms[lookup[hash]].name << std::endl;
+            return;
+        }
+        lookup[hash] = (int)uniforms.size();
+        UniformSlot slot;
+        slot.name = name;
+        slot.location = location;
+        uniforms.push_back(slot);
+    }
+
+    // Zapamiętuje wartość; false = uniform nie istnieje albo ma już tę wartość
+    bool store(Uniform u, const void* value, size_t bytes) {
+        if(!u.valid()) return false;
+        UniformSlot &slot = uniforms[u.index];
+        if(slot.known && std::memcmp(slot.value, value, bytes) == 0) {
+            skippedUploads++;
+            return false;
+        }
+        std::memcpy(slot.value, value, bytes);
+        slot.known = true;
+        uniformUploads++;
+        return true;
+    }
+
+    std::chrono::steady_clock::time_point submitted;
+    uint64_t cacheKey = 0;
+    unsigned int vertex = 0, fragment = 0; // etapy czekające na koniec linkowania
+    bool finished = false;
+
+    // Zlecenie kompilacji obu etapów i linkowania do ID (gdy nie było binarki) - bez pytania o stan,
+    // żeby sterownik mógł kompilować w tle, a kolejne programy dało się zlecić od razu
+    void compile(const char* vShaderCode, const char* fShaderCode) {
         // Vertex Shader
         vertex = glCreateShader(GL_VERTEX_SHADER);
         glShaderSource(vertex, 1, &vShaderCode, NULL);
         glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
 
         // Fragment Shader
         fragment = glCreateShader(GL_FRAGMENT_SHADER);
         glShaderSource(fragment, 1, &fShaderCode, NULL);
         glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
 
         // Shader Program
-        ID = glCreateProgram();
         glAttachShader(ID, vertex);
         glAttachShader(ID, fragment);
+        ProgramCache::markRetrievable(ID);
         glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
-
-        // Usuń shadery po zlinkowaniu
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
     }
 
-    // Aktywacja shadera
-    void use() { 
-        glUseProgram(ID); 
-    }
+    // Po zakończeniu: błędy kompilacji, zapis binarki, tabela uniformów
+    void finish() {
+        if(vertex) {
+            checkCompileErrors(vertex, "VERTEX");
+            checkCompileErrors(fragment, "FRAGMENT");
+            checkCompileErrors(ID, "PROGRAM");
+            GLint linked = 0;
+            glGetProgramiv(ID, GL_LINK_STATUS, &linked);
+            if(linked) ProgramCache::store(ID, cacheKey);
 
-    // Funkcje pomocnicze do ustawiania uniformów
-    void setBool(const std::string &name, bool value) const {         
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
-    }
-    void setInt(const std::string &name, int value) const { 
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
-    }
-    void setFloat(const std::string &name, float value) const { 
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
-    }
-    void setVec3(const std::string &name, float x, float y, float z) const { 
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z); 
+            // Usuń shadery po zlinkowaniu
+            glDeleteShader(vertex);
+            glDeleteShader(fragment);
+            vertex = fragment = 0;
+        }
+        reflectUniforms();
+        buildMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - submitted).count();
+        finished = true;
     }
-    void setMat4(const std::string &name, const glm::mat4 &mat) const {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+
+    // "#version" musi być pierwszą dyrektywą - definicje wchodzą po nim, "#line" zachowuje numery linii w błędach
+    static std::string withDefines(const std::string &code, const std::string &defines) {
+        if(defines.empty()) return code;
+        size_t versionEnd = code.find('\n');
+        if(versionEnd == std::string::npos) return code;
+        return code.substr(0, versionEnd + 1) + defines + "#line 2\n" + code.substr(versionEnd + 1);
     }
 
-private:
     // Funkcja sprawdzająca błędy kompilacji
     void checkCompileErrors(unsigned int shader, std::string type) {
         int success;
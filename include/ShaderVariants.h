@@ -0,0 +1,140 @@
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+// Permutacje jednej pary shaderów: zestaw cech (maska bitowa) -> "#define" wstrzyknięte za "#version".
+// Każdy wariant kompiluje się raz i zostaje w pamięci podręcznej pod swoją maską, więc shader.frag
+// nie rozgałęzia się w czasie działania, a sterownik optymalizuje każdą ścieżkę osobno.
+//
+// Kompilacja nie blokuje: request() tylko zleca program (z KHR_parallel_shader_compile sterownik
+// kompiluje w swoich wątkach), a get() do czasu gotowości zwraca program zastępczy, zbudowany od razu.
+
+#include "Shader.h"
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Cechy wariantu; materiał wybiera je przy wczytywaniu (MaterialRules), scena tylko odczytuje
+enum ShaderFeature : uint32_t {
+    SHADER_TEXTURED = 1u << 0, // tekstura TextureLibrary o numerze DrawData.textureRef (tablice klas rozmiaru, jednostki 0..2);
+                               // bez niej i bez PAINT - kolor z DrawData
+    SHADER_PAINT    = 1u << 1, // lakier: numer TextureLibrary z atrybutu instancji PaintLayer (te same tablice, jednostki 0..2)
+    SHADER_GLASS    = 1u << 2, // ostry, mocny odblask szyb
+    SHADER_EMISSIVE = 1u << 3, // świeci własnym kolorem - bez oświetlenia (lampy)
+    SHADER_TILING   = 1u << 4  // UV mnożone przez DrawData.tiling; bez niej UV prosto z siatki
+};
+
+class ShaderVariants {
+public:
+    static constexpr int FEATURE_COUNT = 5;
+
+    // setup: jednorazowo po skompilowaniu (bloki UBO, jednostki samplerów);
+    // fallbackFeatures: wariant zastępczy, budowany od razu (z czekaniem) w konstruktorze
+    ShaderVariants(std::string vertexPath, std::string fragmentPath, std::function<void(Shader&)> setup, uint32_t fallbackFeatures)
+        : vertexPath(std::move(vertexPath)), fragmentPath(std::move(fragmentPath)), setup(std::move(setup)) {
+        fallback = &wait(fallbackFeatures);
+    }
+
+    ShaderVariants(const ShaderVariants&) = delete;
+    ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+    // Zleca kompilację wariantu, jeśli jeszcze go nie ma - wraca od razu
+    void request(uint32_t features) {
+        if(programs.count(features)) return;
+        Variant variant;
+        variant.shader.reset(new Shader(vertexPath.c_str(), fragmentPath.c_str(), defines(features), true));
+        programs.emplace(features, std::move(variant));
+    }
+
+    // Gotowy program dla maski cech albo zastępczy, dopóki sterownik go kompiluje (brakujący wariant jest zlecany)
+    Shader& get(uint32_t features) {
+        auto it = programs.find(features);
+        if(it == programs.end()) {
+            request(features);
+            return *fallback;
+        }
+        Variant &variant = it->second;
+        if(!variant.prepared) {
+            if(!variant.shader->ready()) return *fallback;
+            prepare(features, variant);
+        }
+        return *variant.shader;
+    }
+
+    // Program dla maski cech - czeka na koniec kompilacji (start, benchmarki)
+    Shader& wait(uint32_t features) {
+        request(features);
+        Variant &variant = programs[features];
+        if(!variant.prepared) {
+            variant.shader->wait();
+            prepare(features, variant);
+        }
+        return *variant.shader;
+    }
+
+    size_t size() const { return programs.size(); }
+
+    // Ile zleconych wariantów jeszcze się kompiluje (stan z ostatnich get())
+    size_t pending() const {
+        size_t count = 0;
+        for(const auto &entry : programs) count += entry.second.prepared ? 0 : 1;
+        return count;
+    }
+
+    // Sprawdza stan wszystkich zleconych wariantów (bez blokowania); true = wszystkie gotowe
+    bool poll() {
+        bool all = true;
+        for(auto &entry : programs)
+            if(!entry.second.prepared) {
+                if(entry.second.shader->ready()) prepare(entry.first, entry.second);
+                else all = false;
+            }
+        return all;
+    }
+
+    // Czas budowy każdego nowego programu na konsolę (zimny vs ciepły start, ProgramCache)
+    static inline bool report = true;
+
+    // "#define TEXTURED\n#define TILING\n" itd. - nazwy jak w shader.frag / shader.vert
+    static std::string defines(uint32_t features) {
+        std::string text;
+        for(int bit = 0; bit < FEATURE_COUNT; bit++)
+            if(features & (1u << bit)) text += std::string("#define ") + NAMES[bit] + "\n";
+        return text;
+    }
+
+    // "PAINT TILING" - do komunikatów; "-" dla wariantu bez cech
+    static std::string describe(uint32_t features) {
+        std::string text;
+        for(int bit = 0; bit < FEATURE_COUNT; bit++)
+            if(features & (1u << bit)) text += (text.empty() ? "" : " ") + std::string(NAMES[bit]);
+        return text.empty() ? "-" : text;
+    }
+
+private:
+    static constexpr const char* NAMES[FEATURE_COUNT] = { "TEXTURED", "PAINT", "GLASS", "EMISSIVE", "TILING" };
+
+    struct Variant {
+        std::unique_ptr<Shader> shader;
+        bool prepared = false; // skompilowany i po setup
+    };
+
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::function<void(Shader&)> setup;
+    std::unordered_map<uint32_t, Variant> programs;
+    Shader* fallback = nullptr;
+
+    void prepare(uint32_t features, Variant &variant) {
+        if(setup) setup(*variant.shader);
+        variant.prepared = true;
+        if(report)
+            std::cout << "Program " << vertexPath << " [" << describe(features) << "]: gotowy po " << variant.shader->buildMilliseconds << " ms"
+                      << (variant.shader->fromBinaryCache ? " (binarka z cache)" : " (kompilacja)") << std::endl;
+    }
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef SHOWROOM_LAYOUT_H
+#define SHOWROOM_LAYOUT_H
+
+// Układ salonu wspólny dla aplikacji (main.cpp) i benchmarków (bench.cpp) - te same rzędy stanowisk,
+// modele i światła, żeby pomiary odpowiadały scenie.
+
+#include <glm/glm.hpp>
+
+#include "ClusteredLights.h"
+
+#include <algorithm>
+#include <vector>
+
+const int CAR_COUNT = 5;          // Ile różnych modeli aut mamy (models/car-N.obj)
+const float carSpacing = 3.0f;    // Odstęp między autami (w metrach)
+const int ROW_LENGTH = 10;        // Stanowisk w jednym rzędzie
+const float ROW_SPACING = 6.0f;   // Odstęp między rzędami (w metrach)
+const float SLOT_HEIGHT = 0.65f;  // Wysokość środka auta nad podłogą
+const float PLAYER_HEIGHT = 1.7f; // Sztywna wysokość "oczu" kamery (wzrost człowieka)
+
+// Stanowisko i z count: rzędy po ROW_LENGTH wyśrodkowane na X=0, kolejne rzędy w głąb (-Z)
+inline glm::vec3 slotPosition(int i, int count) {
+    int perRow = std::min(count, ROW_LENGTH);
+    float startX = -((perRow - 1) * carSpacing) / 2.0f;
+    return glm::vec3(startX + (i % ROW_LENGTH) * carSpacing, SLOT_HEIGHT, -(i / ROW_LENGTH) * ROW_SPACING);
+}
+
+// Skala podłogi 20x20 m, która obejmuje wszystkie rzędy z zapasem
+inline float floorScaleFor(int count) {
+    int rows = (count + ROW_LENGTH - 1) / ROW_LENGTH;
+    int perRow = std::min(count, ROW_LENGTH);
+    float extent = std::max(perRow * carSpacing, rows * ROW_SPACING) + 10.0f;
+    return std::max(1.0f, extent / 20.0f);
+}
+
+// Reflektor nad każdym stanowiskiem (w dół, ciepły) i listwy świetlne co STRIP_SPACING wzdłuż krawędzi podłogi
+// (chłodne, punktowe) - przy setkach stanowisk to setki świateł, a piksel liczy tylko te ze swojego klastra
+inline std::vector<Light> showroomLights(const std::vector<glm::vec3> &slotPositions, float halfExtent) {
+    const float SPOT_HEIGHT = 4.5f;
+    const float STRIP_HEIGHT = 2.5f;
+    const float STRIP_SPACING = 2.5f;
+    std::vector<Light> lights;
+    for(const glm::vec3 &position : slotPositions)
+        lights.push_back(Light::spot(glm::vec3(position.x, SPOT_HEIGHT, position.z), glm::vec3(0.0f, -1.0f, 0.0f), 7.0f,
+                                     glm::vec3(9.0f, 8.2f, 7.0f), 18.0f, 32.0f));
+    float edge = halfExtent - 0.5f;
+    for(float t = -edge; t <= edge; t += STRIP_SPACING) {
+        for(float side : { -edge, edge }) {
+            lights.push_back(Light::point(glm::vec3(side, STRIP_HEIGHT, t), 4.0f, glm::vec3(2.0f, 2.4f, 3.0f)));
+            lights.push_back(Light::point(glm::vec3(t, STRIP_HEIGHT, side), 4.0f, glm::vec3(2.0f, 2.4f, 3.0f)));
+        }
+    }
+    return lights;
+}
+
+#endif
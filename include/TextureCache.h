@@ -0,0 +1,373 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+// Wypieczone tekstury: BC1 (nieprzezroczyste) / BC3 (z alfą) z gotowym łańcuchem mipmap
+// w kontenerze KTX 1.1. Pieczenie offline ("--bake"), przy starcie tylko odczyt pliku
+// i glCompressedTexImage2D - bez dekodowania JPG i bez glGenerateMipmap.
+//
+// textures/car_paint_1.jpg -> textures/car_paint_1.ktx
+
+#include "GLExtensions.h"
+#include "MappedFile.h"
+#include "stb_image.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace TextureCache {
+
+const unsigned char KTX_IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+const uint32_t KTX_ENDIANNESS = 0x04030201;
+const char     SOURCE_KEY[]   = "SalonSource"; // "<rozmiar> <czas modyfikacji> <flip>" pliku źródłowego
+
+struct KtxHeader {
+    unsigned char identifier[12];
+    uint32_t endianness;
+    uint32_t glType;
+    uint32_t glTypeSize;
+    uint32_t glFormat;
+    uint32_t glInternalFormat;
+    uint32_t glBaseInternalFormat;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t numberOfArrayElements;
+    uint32_t numberOfFaces;
+    uint32_t numberOfMipmapLevels;
+    uint32_t bytesOfKeyValueData;
+};
+
+// Jeden poziom mipmapy wewnątrz CompressedImage::data
+struct MipLevel {
+    int width, height;
+    size_t offset, size;
+};
+
+struct CompressedImage {
+    GLenum internalFormat = 0;
+    std::vector<unsigned char> data;
+    std::vector<MipLevel> levels;
+};
+
+inline std::string cachedPathFor(const std::string &sourcePath) {
+    size_t dot = sourcePath.find_last_of('.');
+    size_t slash = sourcePath.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return sourcePath + ".ktx";
+    return sourcePath.substr(0, dot) + ".ktx";
+}
+
+inline std::string sourceTag(const std::string &sourcePath, bool flipVertically) {
+    uint64_t size;
+    int64_t time;
+    if(!fileStamp(sourcePath, size, time)) return "";
+    return std::to_string(size) + " " + std::to_string(time) + " " + (flipVertically ? "1" : "0");
+}
+
+// --- Kompresja bloków 4x4 ---------------------------------------------------
+
+inline uint16_t packColor565(const float c[3]) {
+    int r = std::clamp(static_cast<int>(c[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+    int g = std::clamp(static_cast<int>(c[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+    int b = std::clamp(static_cast<int>(c[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+inline void unpackColor565(uint16_t c, int out[3]) {
+    int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+    out[0] = (r << 3) | (r >> 2);
+    out[1] = (g << 2) | (g >> 4);
+    out[2] = (b << 3) | (b >> 2);
+}
+
+// Blok koloru BC1 (4-kolorowy): końce wzdłuż głównej osi (PCA) kolorów bloku
+inline void encodeColorBlock(const unsigned char block[16][4], unsigned char out[8]) {
+    float mean[3] = { 0, 0, 0 };
+    for(int i = 0; i < 16; i++)
+        for(int c = 0; c < 3; c++) mean[c] += block[i][c];
+    for(int c = 0; c < 3; c++) mean[c] /= 16.0f;
+
+    float cov[6] = { 0, 0, 0, 0, 0, 0 }; // rr rg rb gg gb bb
+    for(int i = 0; i < 16; i++) {
+        float r = block[i][0] - mean[0], g = block[i][1] - mean[1], b = block[i][2] - mean[2];
+        cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+        cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+    }
+
+    // Kilka iteracji potęgowych wystarcza dla macierzy 3x3
+    float axis[3] = { 1.0f, 1.0f, 1.0f };
+    for(int iter = 0; iter < 8; iter++) {
+        float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        float len = std::max(std::max(std::fabs(x), std::fabs(y)), std::fabs(z));
+        if(len < 1e-6f) break; // blok jednolity
+        axis[0] = x / len; axis[1] = y / len; axis[2] = z / len;
+    }
+    float axisLen2 = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+    float minT = 0.0f, maxT = 0.0f;
+    for(int i = 0; i < 16; i++) {
+        float t = ((block[i][0] - mean[0]) * axis[0] + (block[i][1] - mean[1]) * axis[1] + (block[i][2] - mean[2]) * axis[2]) / axisLen2;
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+
+    float hi[3], lo[3];
+    for(int c = 0; c < 3; c++) {
+        hi[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+        lo[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+    }
+
+    uint16_t c0 = packColor565(hi), c1 = packColor565(lo);
+    if(c0 < c1) std::swap(c0, c1); // c0 > c1 = tryb 4-kolorowy
+
+    uint32_t indices = 0;
+    if(c0 != c1) {
+        int p[4][3];
+        unpackColor565(c0, p[0]);
+        unpackColor565(c1, p[1]);
+        for(int c = 0; c < 3; c++) {
+            p[2][c] = (2 * p[0][c] + p[1][c]) / 3;
+            p[3][c] = (p[0][c] + 2 * p[1][c]) / 3;
+        }
+        for(int i = 0; i < 16; i++) {
+            int best = 0, bestDist = 1 << 30;
+            for(int k = 0; k < 4; k++) {
+                int dr = block[i][0] - p[k][0], dg = block[i][1] - p[k][1], db = block[i][2] - p[k][2];
+                int dist = dr * dr + dg * dg + db * db;
+                if(dist < bestDist) { bestDist = dist; best = k; }
+            }
+            indices |= static_cast<uint32_t>(best) << (2 * i);
+        }
+    }
+
+    std::memcpy(out + 0, &c0, 2);
+    std::memcpy(out + 2, &c1, 2);
+    std::memcpy(out + 4, &indices, 4);
+}
+
+// Blok alfy BC3: 8 wartości interpolowanych między min i max
+inline void encodeAlphaBlock(const unsigned char block[16][4], unsigned char out[8]) {
+    int a0 = 0, a1 = 255;
+    for(int i = 0; i < 16; i++) {
+        a0 = std::max(a0, static_cast<int>(block[i][3]));
+        a1 = std::min(a1, static_cast<int>(block[i][3]));
+    }
+
+    uint64_t bits = 0;
+    if(a0 != a1) {
+        int palette[8] = { a0, a1 };
+        for(int k = 1; k <= 6; k++)
+            palette[k + 1] = ((7 - k) * a0 + k * a1) / 7;
+        for(int i = 0; i < 16; i++) {
+            int best = 0, bestDist = 1 << 30;
+            for(int k = 0; k < 8; k++) {
+                int dist = std::abs(block[i][3] - palette[k]);
+                if(dist < bestDist) { bestDist = dist; best = k; }
+            }
+            bits |= static_cast<uint64_t>(best) << (3 * i);
+        }
+    }
+
+    out[0] = static_cast<unsigned char>(a0);
+    out[1] = static_cast<unsigned char>(a1);
+    for(int i = 0; i < 6; i++)
+        out[2 + i] = static_cast<unsigned char>((bits >> (8 * i)) & 0xFF);
+}
+
+// RGBA8 -> BC1/BC3; krawędzie obrazków, które nie są wielokrotnością 4, powielamy
+inline void compressLevel(const unsigned char* rgba, int width, int height, bool withAlpha, std::vector<unsigned char> &out) {
+    for(int by = 0; by < height; by += 4) {
+        for(int bx = 0; bx < width; bx += 4) {
+            unsigned char block[16][4];
+            for(int y = 0; y < 4; y++) {
+                for(int x = 0; x < 4; x++) {
+                    int sx = std::min(bx + x, width - 1), sy = std::min(by + y, height - 1);
+                    std::memcpy(block[y * 4 + x], rgba + (static_cast<size_t>(sy) * width + sx) * 4, 4);
+                }
+            }
+            unsigned char encoded[16];
+            size_t blockSize = 8;
+            if(withAlpha) {
+                encodeAlphaBlock(block, encoded);
+                encodeColorBlock(block, encoded + 8);
+                blockSize = 16;
+            } else {
+                encodeColorBlock(block, encoded);
+            }
+            out.insert(out.end(), encoded, encoded + blockSize);
+        }
+    }
+}
+
+// Następny poziom mipmapy: filtr pudełkowy 2x2
+inline std::vector<unsigned char> downsample(const std::vector<unsigned char> &rgba, int width, int height, int &outWidth, int &outHeight) {
+    outWidth = std::max(1, width / 2);
+    outHeight = std::max(1, height / 2);
+    std::vector<unsigned char> result(static_cast<size_t>(outWidth) * outHeight * 4);
+    for(int y = 0; y < outHeight; y++) {
+        for(int x = 0; x < outWidth; x++) {
+            int x0 = std::min(2 * x, width - 1), x1 = std::min(2 * x + 1, width - 1);
+            int y0 = std::min(2 * y, height - 1), y1 = std::min(2 * y + 1, height - 1);
+            for(int c = 0; c < 4; c++) {
+                int sum = rgba[(static_cast<size_t>(y0) * width + x0) * 4 + c] + rgba[(static_cast<size_t>(y0) * width + x1) * 4 + c]
+                        + rgba[(static_cast<size_t>(y1) * width + x0) * 4 + c] + rgba[(static_cast<size_t>(y1) * width + x1) * 4 + c];
+                result[(static_cast<size_t>(y) * outWidth + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+    return result;
+}
+
+// Pełny łańcuch mipmap (aż do 1x1) w jednym CompressedImage. GL_RGBA8 = poziomy bez kompresji (sterownik bez S3TC)
+inline void buildMipChain(std::vector<unsigned char> rgba, int width, int height, GLenum internalFormat, CompressedImage &image) {
+    image.internalFormat = internalFormat;
+    for(;;) {
+        size_t offset = image.data.size();
+        if(internalFormat == GL_RGBA8) image.data.insert(image.data.end(), rgba.begin(), rgba.end());
+        else compressLevel(rgba.data(), width, height, internalFormat == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, image.data);
+        image.levels.push_back({ width, height, offset, image.data.size() - offset });
+        if(width == 1 && height == 1) break;
+        rgba = downsample(rgba, width, height, width, height);
+    }
+}
+
+// --- Kontener KTX -----------------------------------------------------------
+
+inline bool write(const std::string &cachePath, const std::string &tag, const CompressedImage &image) {
+    std::string keyValue = std::string(SOURCE_KEY) + '\0' + tag + '\0';
+    uint32_t keyValueSize = static_cast<uint32_t>(keyValue.size());
+    size_t keyValuePadding = padTo4(keyValue.size()) - keyValue.size();
+
+    KtxHeader header;
+    std::memcpy(header.identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER));
+    header.endianness = KTX_ENDIANNESS;
+    header.glType = 0;     // skompresowane
+    header.glTypeSize = 1;
+    header.glFormat = 0;
+    header.glInternalFormat = image.internalFormat;
+    header.glBaseInternalFormat = image.internalFormat == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT ? GL_RGBA : GL_RGB;
+    header.pixelWidth = image.levels[0].width;
+    header.pixelHeight = image.levels[0].height;
+    header.pixelDepth = 0;
+    header.numberOfArrayElements = 0;
+    header.numberOfFaces = 1;
+    header.numberOfMipmapLevels = static_cast<uint32_t>(image.levels.size());
+    header.bytesOfKeyValueData = static_cast<uint32_t>(sizeof(uint32_t) + keyValue.size() + keyValuePadding);
+
+    std::string tmpPath = cachePath + ".tmp";
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if(!out) return false;
+
+    static const char zeros[4] = { 0, 0, 0, 0 };
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(&keyValueSize), sizeof(keyValueSize));
+    out.write(keyValue.data(), keyValue.size());
+    out.write(zeros, keyValuePadding);
+    for(const MipLevel &level : image.levels) {
+        // Bloki BC mają 8 lub 16 bajtów, więc poziomy są już wyrównane do 4
+        uint32_t imageSize = static_cast<uint32_t>(level.size);
+        out.write(reinterpret_cast<const char*>(&imageSize), sizeof(imageSize));
+        out.write(reinterpret_cast<const char*>(image.data.data() + level.offset), level.size);
+    }
+    out.close();
+    if(!out) return false;
+
+    std::error_code ec;
+    std::filesystem::remove(cachePath, ec);
+    std::filesystem::rename(tmpPath, cachePath, ec);
+    return !ec;
+}
+
+// Odczyt na wątku roboczym. false = brak pliku, inny format albo źródło zmieniło się od pieczenia
+inline bool read(const std::string &cachePath, const std::string &tag, CompressedImage &image) {
+    MappedFile file;
+    if(!file.open(cachePath)) return false;
+
+    ByteReader reader(file.bytes(), file.length());
+    const KtxHeader* header = reader.take<KtxHeader>();
+    if(!header) return false;
+    if(std::memcmp(header->identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) != 0) return false;
+    if(header->endianness != KTX_ENDIANNESS || header->glType != 0) return false;
+    if(header->glInternalFormat != GL_COMPRESSED_RGB_S3TC_DXT1_EXT && header->glInternalFormat != GL_COMPRESSED_RGBA_S3TC_DXT5_EXT) return false;
+    if(header->numberOfFaces != 1 || header->numberOfArrayElements != 0 || header->numberOfMipmapLevels == 0) return false;
+
+    // Szukamy naszego klucza ze znacznikiem pliku źródłowego
+    bool tagMatches = false;
+    const unsigned char* keyValueData = reader.take<unsigned char>(header->bytesOfKeyValueData);
+    if(!keyValueData) return false;
+    ByteReader keyValues(keyValueData, header->bytesOfKeyValueData);
+    while(const uint32_t* pairSize = keyValues.take<uint32_t>()) {
+        const char* pair = keyValues.take<char>(padTo4(*pairSize));
+        if(!pair) break;
+        std::string key(pair, strnlen(pair, *pairSize));
+        if(key == SOURCE_KEY && key.size() + 1 < *pairSize) {
+            std::string value(pair + key.size() + 1, strnlen(pair + key.size() + 1, *pairSize - key.size() - 1));
+            tagMatches = (value == tag);
+        }
+    }
+    if(!tagMatches) return false;
+
+    image.internalFormat = header->glInternalFormat;
+    size_t blockSize = image.internalFormat == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT ? 16 : 8;
+    int width = header->pixelWidth, height = header->pixelHeight;
+    for(uint32_t i = 0; i < header->numberOfMipmapLevels; i++) {
+        const uint32_t* imageSize = reader.take<uint32_t>();
+        if(!imageSize) return false;
+        size_t expected = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * blockSize;
+        if(*imageSize != expected) return false;
+        const unsigned char* pixels = reader.take<unsigned char>(padTo4(*imageSize));
+        if(!pixels) return false;
+
+        image.levels.push_back({ width, height, image.data.size(), *imageSize });
+        image.data.insert(image.data.end(), pixels, pixels + *imageSize);
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    return true;
+}
+
+// Pieczenie jednej tekstury (offline, bez OpenGL)
+inline bool bake(const std::string &sourcePath, bool flipVertically = true) {
+    int width, height, channels;
+    stbi_set_flip_vertically_on_load_thread(flipVertically ? 1 : 0);
+    unsigned char* pixels = stbi_load(sourcePath.c_str(), &width, &height, &channels, 4);
+    if(!pixels) {
+        std::cout << "BLAD::BAKE:: nie udalo sie wczytac " << sourcePath << std::endl;
+        return false;
+    }
+    std::vector<unsigned char> rgba(pixels, pixels + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(pixels);
+
+    // BC3 tylko wtedy, gdy alfa jest naprawdę używana
+    bool withAlpha = false;
+    if(channels == 2 || channels == 4)
+        for(size_t i = 3; i < rgba.size() && !withAlpha; i += 4)
+            withAlpha = rgba[i] != 255;
+
+    CompressedImage image;
+    buildMipChain(std::move(rgba), width, height, withAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT, image);
+
+    std::string cachePath = cachedPathFor(sourcePath);
+    if(!write(cachePath, sourceTag(sourcePath, flipVertically), image)) {
+        std::cout << "BLAD::BAKE:: nie udalo sie zapisac " << cachePath << std::endl;
+        return false;
+    }
+
+    // Porównanie z tym, co trzymałby sterownik dla nieskompresowanego RGB(A)8 z mipmapami (~4/3)
+    size_t rawBytes = static_cast<size_t>(width) * height * (channels == 4 ? 4 : 3) * 4 / 3;
+    std::cout << "Wypieczono: " << cachePath << " (" << (withAlpha ? "BC3" : "BC1") << ", mip: " << image.levels.size()
+              << ", " << rawBytes / 1024 << " KB -> " << image.data.size() / 1024 << " KB)" << std::endl;
+    return true;
+}
+
+} // namespace TextureCache
+
+#endif
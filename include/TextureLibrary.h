@@ -0,0 +1,237 @@
+#ifndef TEXTURE_LIBRARY_H
+#define TEXTURE_LIBRARY_H
+
+// Wszystkie tekstury salonu (podłoga, materiały aut, lakiery) w kilku GL_TEXTURE_2D_ARRAY - po jednej na
+// klasę rozmiaru (256 / 512 / 1024). Każdy plik to jedna warstwa przeskalowana do rozmiaru swojej klasy,
+// z mipmapami, skompresowana (BC1). Tablice są przypięte na stałe do jednostek 0..2, a rysowanie wybiera teksturę numerem
+// (ref = klasa * LAYERS_PER_CLASS + warstwa) z DrawData albo z atrybutu instancji - zmiana materiału
+// między rysowaniami nie wiąże żadnej tekstury.
+
+#include <glad/glad.h>
+
+#include "TextureCache.h"
+#include "TextureStreamer.h"
+#include "stb_image.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+class TextureLibrary {
+public:
+    static constexpr int SIZE_CLASSES = 3;
+    static constexpr int SIZES[SIZE_CLASSES] = { 256, 512, 1024 };
+    static constexpr int LAYERS_PER_CLASS = 256;
+    // Nazwy samplerów w shader.frag; tablica klasy k jest na jednostce k
+    static constexpr const char* SAMPLERS[SIZE_CLASSES] = { "library256", "library512", "library1024" };
+
+    // Szara warstwa zarezerwowana na starcie - brakujący plik albo pełna klasa dostają ją zamiast cudzej tekstury
+    static constexpr int MISSING = 0;
+
+    // Warstwy wypełnia streamer (wątki jego puli + upload przez PBO w pump())
+    explicit TextureLibrary(TextureStreamer &streamer) : streamer(streamer) { files[0].push_back(""); }
+
+    ~TextureLibrary() {
+        for(GLuint texture : textures)
+            if(texture) glDeleteTextures(1, &texture);
+    }
+
+    // Rejestruje plik i od razu zwraca jego numer - klasa z samego nagłówka obrazka (stbi_info).
+    // Brakujący plik i pełna klasa dostają MISSING.
+    int add(const std::string &path) {
+        int width = 0, height = 0, channels = 0;
+        if(!stbi_info(path.c_str(), &width, &height, &channels)) {
+            std::cout << "Blad ladowania tekstury: " << path << std::endl;
+            return MISSING;
+        }
+        int sizeClass = classFor(std::max(width, height));
+        int layer = static_cast<int>(files[sizeClass].size());
+        if(layer >= LAYERS_PER_CLASS) {
+            std::cout << "BLAD::TEKSTURY:: klasa " << SIZES[sizeClass] << " ma juz " << LAYERS_PER_CLASS
+                      << " warstw, " << path << " dostaje szara warstwe" << std::endl;
+            return MISSING;
+        }
+        files[sizeClass].push_back(path);
+        return sizeClass * LAYERS_PER_CLASS + layer;
+    }
+
+    // Tablice od razu w docelowym formacie (BC1, bez S3TC - RGBA8) i z pełnym łańcuchem mipmap, każda warstwa szara.
+    // Pliki przygotowują wątki puli (.ktx z "--bake" albo stb + resample + kompresja), a TextureStreamer::pump()
+    // podmienia warstwy, gdy dane są gotowe - load() nie czeka na dekodowanie.
+    void load() {
+        GLenum format = streamer.compressionSupported() ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_RGBA8;
+        size_t bytes = 0;
+        for(int c = 0; c < SIZE_CLASSES; c++) {
+            // Pusta klasa dostaje jedną szarą warstwę - sampler zawsze wskazuje poprawną teksturę
+            int size = SIZES[c];
+            layerCounts[c] = std::max(1, static_cast<int>(files[c].size()));
+            std::vector<unsigned char> grey = greyLevel(size, layerCounts[c], format);
+
+            if(!textures[c]) glGenTextures(1, &textures[c]);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, textures[c]);
+            // Mniejsze poziomy biorą początek tego samego szarego bufora
+            for(int level = 0, levelSize = size; levelSize >= 1; level++, levelSize /= 2) {
+                size_t levelBytes = layerBytes(levelSize, format) * layerCounts[c];
+                if(format == GL_RGBA8)
+                    glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, levelSize, levelSize, layerCounts[c], 0, GL_RGBA, GL_UNSIGNED_BYTE, grey.data());
+                else
+                    glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, format, levelSize, levelSize, layerCounts[c], 0,
+                                           static_cast<GLsizei>(levelBytes), grey.data());
+                bytes += levelBytes;
+            }
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levelCount(size) - 1);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+            for(size_t layer = 0; layer < files[c].size(); layer++) {
+                const std::string &path = files[c][layer];
+                if(path.empty()) continue; // MISSING zostaje szara
+                streamer.loadLayer(textures[c], static_cast<int>(layer), path,
+                                   [path, size, format](TextureCache::CompressedImage &image) { return prepareLayer(path, size, format, image); });
+            }
+            std::cout << "Tekstury " << size << "x" << size << ": " << layerCounts[c] << " warstw" << std::endl;
+        }
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        totalBytes = bytes;
+        std::cout << "Biblioteka tekstur (" << (format == GL_RGBA8 ? "RGBA8" : "BC1") << "): "
+                  << totalBytes / (1024 * 1024) << " MB" << std::endl;
+    }
+
+    // Tryb offline ("--bake"): warstwa w rozmiarze swojej klasy jako BC1 z mipmapami, zapisana obok źródła (.ktx).
+    // load() bierze ją bez dekodowania, o ile rozmiar i format się zgadzają.
+    static bool bake(const std::string &path) {
+        int width, height, channels;
+        stbi_set_flip_vertically_on_load_thread(true);
+        unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+        if(!pixels) {
+            std::cout << "BLAD::BAKE:: nie udalo sie wczytac " << path << std::endl;
+            return false;
+        }
+        std::vector<unsigned char> rgba(pixels, pixels + static_cast<size_t>(width) * height * 4);
+        stbi_image_free(pixels);
+
+        int size = SIZES[classFor(std::max(width, height))];
+        TextureCache::CompressedImage image;
+        TextureCache::buildMipChain(resample(std::move(rgba), width, height, size), size, size, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, image);
+        std::string cachePath = TextureCache::cachedPathFor(path);
+        if(!TextureCache::write(cachePath, TextureCache::sourceTag(path, true), image)) {
+            std::cout << "BLAD::BAKE:: nie udalo sie zapisac " << cachePath << std::endl;
+            return false;
+        }
+        std::cout << "Wypieczono: " << cachePath << " (BC1 " << size << "x" << size << ", mip: " << image.levels.size()
+                  << ", " << image.data.size() / 1024 << " KB)" << std::endl;
+        return true;
+    }
+
+    // Raz na klatkę: każda klasa na swoją jednostkę
+    void bind() const {
+        for(int c = 0; c < SIZE_CLASSES; c++) {
+            glActiveTexture(GL_TEXTURE0 + c);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, textures[c]);
+        }
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    size_t gpuBytes() const { return totalBytes; }
+
+    // Najbliższa klasa w skali logarytmicznej: do ~362 px -> 256, do ~724 px -> 512, większe -> 1024
+    static int classFor(int size) {
+        for(int c = 0; c < SIZE_CLASSES - 1; c++)
+            if(size * size <= SIZES[c] * SIZES[c + 1]) return c;
+        return SIZE_CLASSES - 1;
+    }
+
+    // Dłuższy bok skalowany do size z zachowaniem proporcji, krótszy powtarzany (jak GL_REPEAT), aż wypełni kwadrat.
+    // Najpierw filtr pudełkowy 2x2, póki dłuższy bok ma co najmniej 2*size, potem dwuliniowo z zawijaniem.
+    static std::vector<unsigned char> resample(std::vector<unsigned char> rgba, int width, int height, int size) {
+        while(std::max(width, height) >= 2 * size)
+            rgba = TextureCache::downsample(rgba, width, height, width, height);
+
+        int longer = std::max(width, height);
+        int scaledWidth = std::max(1, (width * size + longer / 2) / longer);
+        int scaledHeight = std::max(1, (height * size + longer / 2) / longer);
+
+        std::vector<unsigned char> result(static_cast<size_t>(size) * size * 4);
+        for(int y = 0; y < size; y++) {
+            float sy = ((y % scaledHeight) + 0.5f) * height / scaledHeight - 0.5f;
+            int y0 = static_cast<int>(std::floor(sy));
+            float fy = sy - y0;
+            int y1 = wrap(y0 + 1, height);
+            y0 = wrap(y0, height);
+            for(int x = 0; x < size; x++) {
+                float sx = ((x % scaledWidth) + 0.5f) * width / scaledWidth - 0.5f;
+                int x0 = static_cast<int>(std::floor(sx));
+                float fx = sx - x0;
+                int x1 = wrap(x0 + 1, width);
+                x0 = wrap(x0, width);
+                for(int c = 0; c < 4; c++) {
+                    float top = rgba[(static_cast<size_t>(y0) * width + x0) * 4 + c] * (1.0f - fx) + rgba[(static_cast<size_t>(y0) * width + x1) * 4 + c] * fx;
+                    float bottom = rgba[(static_cast<size_t>(y1) * width + x0) * 4 + c] * (1.0f - fx) + rgba[(static_cast<size_t>(y1) * width + x1) * 4 + c] * fx;
+                    result[(static_cast<size_t>(y) * size + x) * 4 + c] = static_cast<unsigned char>(top * (1.0f - fy) + bottom * fy + 0.5f);
+                }
+            }
+        }
+        return result;
+    }
+
+private:
+    TextureStreamer &streamer;
+    std::vector<std::string> files[SIZE_CLASSES];
+    GLuint textures[SIZE_CLASSES] = { 0, 0, 0 };
+    int layerCounts[SIZE_CLASSES] = { 0, 0, 0 };
+    size_t totalBytes = 0;
+
+    static int wrap(int i, int n) { return ((i % n) + n) % n; }
+
+    static int levelCount(int size) {
+        int levels = 1;
+        while(size > 1) { size /= 2; levels++; }
+        return levels;
+    }
+
+    // Bloki BC 4x4 (poziomy 2x2 i 1x1 to też jeden blok)
+    static size_t layerBytes(int size, GLenum format) {
+        if(format == GL_RGBA8) return static_cast<size_t>(size) * size * 4;
+        return static_cast<size_t>((size + 3) / 4) * ((size + 3) / 4) * 8;
+    }
+
+    // Poziom 0 wszystkich warstw w kolorze szarym (128)
+    static std::vector<unsigned char> greyLevel(int size, int layers, GLenum format) {
+        if(format == GL_RGBA8) return std::vector<unsigned char>(layerBytes(size, format) * layers, 128);
+        unsigned char pixels[16 * 4];
+        std::fill(pixels, pixels + sizeof(pixels), 128);
+        std::vector<unsigned char> block;
+        TextureCache::compressLevel(pixels, 4, 4, false, block);
+        std::vector<unsigned char> grey;
+        grey.reserve(layerBytes(size, format) * layers);
+        for(size_t i = 0; i < layerBytes(size, format) * layers; i += block.size())
+            grey.insert(grey.end(), block.begin(), block.end());
+        return grey;
+    }
+
+    // Wątek roboczy: wypieczony .ktx w rozmiarze i formacie tablicy, inaczej dekodowanie, resample i kompresja tutaj
+    static bool prepareLayer(const std::string &path, int size, GLenum format, TextureCache::CompressedImage &image) {
+        if(format != GL_RGBA8 &&
+           TextureCache::read(TextureCache::cachedPathFor(path), TextureCache::sourceTag(path, true), image) &&
+           image.internalFormat == format && static_cast<int>(image.levels.size()) == levelCount(size) &&
+           image.levels[0].width == size && image.levels[0].height == size)
+            return true;
+        image = TextureCache::CompressedImage();
+
+        int width, height, channels;
+        stbi_set_flip_vertically_on_load_thread(true);
+        unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+        if(!pixels) return false;
+        std::vector<unsigned char> rgba(pixels, pixels + static_cast<size_t>(width) * height * 4);
+        stbi_image_free(pixels);
+        TextureCache::buildMipChain(resample(std::move(rgba), width, height, size), size, size, format, image);
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,371 @@
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+#include <glad/glad.h>
+#include "stb_image.h"
+
+#include "TextureCache.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Asynchroniczne ładowanie tekstur:
+//  - load() od razu zwraca ID tekstury z zastępczym pikselem 1x1 (można ją bindować),
+//  - wątki robocze czytają wypieczony .ktx (BC1/BC3 + mipmapy) albo dekodują JPG/PNG (stb_image),
+//  - pump() na wątku renderującym kopiuje piksele do PBO i wysyła je do tej samej tekstury,
+//  - fence na każdym PBO mówi, kiedy GPU skończyło czytać (wolny PBO + tekstura gotowa).
+// loadLayer() robi to samo dla jednej warstwy istniejącej tablicy (TextureLibrary) - dane przygotowuje wołający.
+class TextureStreamer {
+public:
+    explicit TextureStreamer(ThreadPool &pool, int bufferCount = 4) : pool(pool) {
+        // Sprawdzane tutaj, bo wątki robocze nie mają kontekstu GL
+        compressedSupported = hasGLExtension("GL_EXT_texture_compression_s3tc");
+        buffers.resize(bufferCount);
+        for(PixelBuffer &buffer : buffers)
+            glGenBuffers(1, &buffer.pbo);
+    }
+
+    ~TextureStreamer() {
+        for(PixelBuffer &buffer : buffers) {
+            if(buffer.fence) glDeleteSync(buffer.fence);
+            glDeleteBuffers(1, &buffer.pbo);
+        }
+        std::lock_guard<std::mutex> lock(decodedMutex);
+        for(Decoded &image : decoded)
+            stbi_image_free(image.pixels);
+    }
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // Wywoływane z wątku renderującego
+    unsigned int load(const std::string &path, bool flipVertically = true) {
+        if(idle()) startTime = std::chrono::steady_clock::now();
+        requested++;
+        reported = false;
+
+        unsigned int textureID;
+        glGenTextures(1, &textureID);
+        pending.insert(textureID);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+
+        // Zastępczy szary piksel, dopóki nie przyjdzie właściwy obrazek
+        const unsigned char placeholder[3] = { 128, 128, 128 };
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, placeholder);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        // Ustawienia powtarzania (GL_REPEAT) i filtrowania
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        pool.enqueue([this, textureID, path, flipVertically] {
+            Decoded image;
+            image.textureID = textureID;
+            image.path = path;
+
+            // Szybka ścieżka: aktualny .ktx - bez dekodowania i bez generowania mipmap
+            if(compressedSupported &&
+               TextureCache::read(TextureCache::cachedPathFor(path), TextureCache::sourceTag(path, flipVertically), image.compressed)) {
+                std::lock_guard<std::mutex> lock(decodedMutex);
+                decoded.push_back(std::move(image));
+                return;
+            }
+            image.compressed = TextureCache::CompressedImage();
+
+            // Flaga per wątek - globalna stbi_set_flip_vertically_on_load nie jest bezpieczna
+            stbi_set_flip_vertically_on_load_thread(flipVertically ? 1 : 0);
+            image.pixels = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 0);
+
+            std::lock_guard<std::mutex> lock(decodedMutex);
+            decoded.push_back(image);
+        });
+        return textureID;
+    }
+
+    // Warstwa GL_TEXTURE_2D_ARRAY: prepare na wątku roboczym daje cały łańcuch mipmap w formacie tablicy
+    // (BC albo GL_RGBA8), pump() wysyła go przez PBO. Do tego czasu warstwa trzyma to, co wpisał wołający.
+    // prepare == false: warstwa zostaje zastępcza.
+    void loadLayer(GLuint arrayTexture, int layer, const std::string &path, std::function<bool(TextureCache::CompressedImage&)> prepare) {
+        if(idle()) startTime = std::chrono::steady_clock::now();
+        requested++;
+        reported = false;
+
+        pool.enqueue([this, arrayTexture, layer, path, prepare] {
+            Decoded image;
+            image.textureID = arrayTexture;
+            image.layer = layer;
+            image.path = path;
+            if(!prepare(image.compressed)) image.compressed = TextureCache::CompressedImage();
+
+            std::lock_guard<std::mutex> lock(decodedMutex);
+            decoded.push_back(std::move(image));
+        });
+    }
+
+    // Sprawdzane w konstruktorze (wątek z kontekstem GL)
+    bool compressionSupported() const { return compressedSupported; }
+
+    // Wysyła zdekodowane obrazki na GPU w limicie czasu (co najmniej jeden na wywołanie)
+    void pump(double budgetMs) {
+        if(idle()) return;
+        auto frameStart = std::chrono::steady_clock::now();
+
+        retireFinishedUploads();
+
+        for(;;) {
+            PixelBuffer* buffer = freeBuffer();
+            if(!buffer) break; // wszystkie PBO jeszcze czytane przez GPU
+
+            Decoded image;
+            {
+                std::lock_guard<std::mutex> lock(decodedMutex);
+                if(decoded.empty()) break;
+                image = std::move(decoded.front());
+                decoded.pop_front();
+            }
+            if(image.layer < 0 && cancelled.count(image.textureID)) {
+                // Zwolniona przed wysłaniem - nie ma po co zajmować PBO
+                stbi_image_free(image.pixels);
+                finish(image.textureID, 0);
+                continue;
+            }
+            upload(*buffer, image);
+
+            if(elapsedMs(frameStart) >= budgetMs) break;
+        }
+
+        if(idle() && !reported) {
+            reported = true;
+            std::cout << "Tekstury zaladowane w " << elapsedMs(startTime) << " ms" << std::endl;
+        }
+    }
+
+    // true, gdy tekstura ma już właściwe piksele (fence przeszedł)
+    bool isReady(unsigned int textureID) const { return ready.count(textureID) != 0; }
+
+    // Pamięć GPU tekstury razem z mipmapami (0, dopóki się nie wczyta)
+    size_t bytes(unsigned int textureID) const {
+        auto it = textureBytes.find(textureID);
+        return it != textureBytes.end() ? it->second : 0;
+    }
+
+    // Usuwa teksturę. Jeśli jeszcze się wczytuje, usunięcie czeka na koniec wczytywania -
+    // inaczej GL mógłby oddać to samo ID nowej teksturze, a stary upload by ją nadpisał.
+    void release(unsigned int textureID) {
+        if(pending.count(textureID)) {
+            cancelled.insert(textureID);
+            return;
+        }
+        glDeleteTextures(1, &textureID);
+        ready.erase(textureID);
+        textureBytes.erase(textureID);
+    }
+
+    bool idle() const { return completed == requested; }
+
+private:
+    struct Decoded {
+        unsigned int textureID = 0;
+        int layer = -1;           // >= 0: warstwa tablicy z loadLayer()
+        std::string path;
+        unsigned char* pixels = nullptr;
+        int width = 0, height = 0, channels = 0;
+        TextureCache::CompressedImage compressed; // niepuste = ścieżka .ktx
+    };
+
+    struct PixelBuffer {
+        GLuint pbo = 0;
+        GLsync fence = 0;         // != 0: GPU może jeszcze czytać z tego PBO
+        unsigned int textureID = 0;
+        size_t textureBytes = 0;
+        bool layer = false;       // tablice biblioteki nie trafiają do ready/textureBytes
+    };
+
+    ThreadPool &pool;
+    std::vector<PixelBuffer> buffers;
+    bool compressedSupported = false;
+
+    std::mutex decodedMutex;
+    std::deque<Decoded> decoded; // zdekodowane, czekają na upload
+
+    // Tylko wątek renderujący
+    std::unordered_set<unsigned int> ready;
+    std::unordered_set<unsigned int> pending;   // load() bez zakończonego uploadu
+    std::unordered_set<unsigned int> cancelled; // release() w trakcie wczytywania
+    std::unordered_map<unsigned int, size_t> textureBytes;
+    int requested = 0;
+    int completed = 0;
+    bool reported = false;
+    std::chrono::steady_clock::time_point startTime;
+
+    static double elapsedMs(std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    }
+
+    void retireFinishedUploads() {
+        for(PixelBuffer &buffer : buffers) {
+            if(!buffer.fence) continue;
+            GLenum status = glClientWaitSync(buffer.fence, 0, 0);
+            if(status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+                glDeleteSync(buffer.fence);
+                buffer.fence = 0;
+                if(buffer.layer) completed++;
+                else finish(buffer.textureID, buffer.textureBytes);
+            }
+        }
+    }
+
+    // Koniec wczytywania (textureBytes == 0: nieudane, zostaje zastępczy piksel)
+    void finish(unsigned int textureID, size_t bytes) {
+        completed++;
+        pending.erase(textureID);
+        if(cancelled.erase(textureID)) {
+            glDeleteTextures(1, &textureID);
+            return;
+        }
+        if(bytes == 0) return;
+        ready.insert(textureID);
+        textureBytes[textureID] = bytes;
+    }
+
+    PixelBuffer* freeBuffer() {
+        for(PixelBuffer &buffer : buffers)
+            if(!buffer.fence) return &buffer;
+        return nullptr;
+    }
+
+    void upload(PixelBuffer &buffer, Decoded &image) {
+        buffer.layer = false;
+        if(image.layer >= 0) {
+            uploadLayer(buffer, image);
+            return;
+        }
+        if(!image.compressed.levels.empty()) {
+            uploadCompressed(buffer, image);
+            return;
+        }
+        if(!image.pixels) {
+            std::cout << "Nie udalo sie wczytac tekstury: " << image.path << std::endl;
+            finish(image.textureID, 0);
+            return;
+        }
+
+        GLenum format = GL_RGB;
+        if (image.channels == 1) format = GL_RED;
+        else if (image.channels == 2) format = GL_RG;
+        else if (image.channels == 3) format = GL_RGB; // .jpg zazwyczaj
+        else if (image.channels == 4) format = GL_RGBA; // .png zazwyczaj
+
+        // Osierocenie bufora (glBufferData z NULL) - nie czekamy na poprzednią zawartość
+        size_t size = static_cast<size_t>(image.width) * image.height * image.channels;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.pbo);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+        void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if(dst) std::memcpy(dst, image.pixels, size);
+        stbi_image_free(image.pixels);
+        image.pixels = nullptr;
+        if(!dst || glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE) {
+            std::cout << "Nie udalo sie wyslac tekstury: " << image.path << std::endl;
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            finish(image.textureID, 0);
+            return;
+        }
+
+        // Dane płyną z PBO (offset 0), więc sterownik może kopiować asynchronicznie
+        glBindTexture(GL_TEXTURE_2D, image.textureID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, (void*)0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        buffer.textureID = image.textureID;
+        buffer.textureBytes = static_cast<size_t>(image.width) * image.height * 4 * 4 / 3; // sterowniki trzymają RGB jako RGBA
+    }
+
+    // Cały łańcuch mipmap do zmapowanego PBO (zostaje zbindowany przy sukcesie)
+    bool copyToBuffer(PixelBuffer &buffer, const TextureCache::CompressedImage &chain, const std::string &path) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.pbo);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, chain.data.size(), NULL, GL_STREAM_DRAW);
+        void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, chain.data.size(), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if(dst) std::memcpy(dst, chain.data.data(), chain.data.size());
+        if(!dst || glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE) {
+            std::cout << "Nie udalo sie wyslac tekstury: " << path << std::endl;
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return false;
+        }
+        return true;
+    }
+
+    // Cały łańcuch mipmap naraz do PBO, potem glCompressedTexImage2D z offsetami poziomów
+    void uploadCompressed(PixelBuffer &buffer, Decoded &image) {
+        const TextureCache::CompressedImage &compressed = image.compressed;
+        if(!copyToBuffer(buffer, compressed, image.path)) {
+            finish(image.textureID, 0);
+            return;
+        }
+
+        glBindTexture(GL_TEXTURE_2D, image.textureID);
+        for(size_t level = 0; level < compressed.levels.size(); level++) {
+            const TextureCache::MipLevel &mip = compressed.levels[level];
+            glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), compressed.internalFormat, mip.width, mip.height, 0,
+                                   static_cast<GLsizei>(mip.size), (void*)mip.offset);
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(compressed.levels.size()) - 1);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        buffer.textureBytes = compressed.data.size();
+        image.compressed = TextureCache::CompressedImage();
+        buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        buffer.textureID = image.textureID;
+    }
+
+    // Łańcuch warstwy do PBO, potem glCompressedTexSubImage3D / glTexSubImage3D każdego poziomu w jej miejscu tablicy
+    void uploadLayer(PixelBuffer &buffer, Decoded &image) {
+        const TextureCache::CompressedImage &chain = image.compressed;
+        if(chain.levels.empty()) {
+            std::cout << "Nie udalo sie wczytac tekstury: " << image.path << std::endl;
+            completed++;
+            return;
+        }
+        if(!copyToBuffer(buffer, chain, image.path)) {
+            completed++;
+            return;
+        }
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, image.textureID);
+        for(size_t level = 0; level < chain.levels.size(); level++) {
+            const TextureCache::MipLevel &mip = chain.levels[level];
+            if(chain.internalFormat == GL_RGBA8)
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, static_cast<GLint>(level), 0, 0, image.layer, mip.width, mip.height, 1,
+                                GL_RGBA, GL_UNSIGNED_BYTE, (void*)mip.offset);
+            else
+                glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, static_cast<GLint>(level), 0, 0, image.layer, mip.width, mip.height, 1,
+                                          chain.internalFormat, static_cast<GLsizei>(mip.size), (void*)mip.offset);
+        }
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        image.compressed = TextureCache::CompressedImage();
+        buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        buffer.textureID = image.textureID;
+        buffer.textureBytes = 0; // pamięć tablicy liczy TextureLibrary
+        buffer.layer = true;
+    }
+};
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Prosta pula wątków roboczych (kolejka FIFO zadań bez wyniku).
+// Zadania nie mogą dotykać OpenGL - kontekst ma tylko wątek GLUT.
+class ThreadPool {
+public:
+    // 0 = tyle wątków ile rdzeni, minus jeden dla wątku renderującego
+    explicit ThreadPool(unsigned int threadCount = 0) {
+        if(threadCount == 0) {
+            unsigned int cores = std::thread::hardware_concurrency();
+            threadCount = cores > 1 ? cores - 1 : 1;
+        }
+        for(unsigned int i = 0; i < threadCount; i++)
+            workers.emplace_back([this] { workerLoop(); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for(std::thread &worker : workers)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void enqueue(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        wakeUp.notify_one();
+    }
+
+    unsigned int size() const { return static_cast<unsigned int>(workers.size()); }
+
+    // fn(0..count-1) na wątku wywołującym i wolnych wątkach puli; wraca, gdy wszystkie indeksy są zrobione.
+    // Indeksy rozdaje licznik - spóźniony wątek puli (zajęty np. importem) znajdzie go wyczerpanym i wyjdzie,
+    // więc czekamy najwyżej na indeksy, które ktoś już wziął.
+    void parallelFor(int count, const std::function<void(int)> &fn) {
+        struct Job {
+            std::function<void(int)> fn;
+            int count = 0;
+            std::atomic<int> next{ 0 };
+            std::atomic<int> done{ 0 };
+
+            void run() {
+                int i;
+                while((i = next.fetch_add(1)) < count) {
+                    fn(i);
+                    done.fetch_add(1);
+                }
+            }
+        };
+        std::shared_ptr<Job> job = std::make_shared<Job>();
+        job->fn = fn;
+        job->count = count;
+
+        unsigned int helpers = std::min<unsigned int>(size(), static_cast<unsigned int>(std::max(count - 1, 0)));
+        for(unsigned int i = 0; i < helpers; i++)
+            enqueue([job] { job->run(); });
+        job->run();
+        while(job->done.load() < count) std::this_thread::yield();
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    bool stopping = false;
+
+    void workerLoop() {
+        for(;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeUp.wait(lock, [this] { return stopping || !tasks.empty(); });
+                // Przy zamykaniu dokończ kolejkę, żeby nie zgubić zadań w połowie
+                if(tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+#endif
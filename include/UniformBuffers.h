@@ -0,0 +1,157 @@
+#ifndef UNIFORM_BUFFERS_H
+#define UNIFORM_BUFFERS_H
+
+// Bloki uniformów (UBO, std140) wspólne dla wszystkich programów:
+//  - FrameData (binding 0): kamera i światło, wysyłane raz na klatkę,
+//  - DrawData  (binding 1): dane jednego rysowania, zbierane w pierścieniu i wysyłane jednym
+//    mapowaniem na klatkę; przed rysowaniem podpinamy tylko zakres (glBindBufferRange).
+// GL 3.3 nie ma trwałego mapowania (GL_MAP_PERSISTENT_BIT to 4.4), więc pierścień zapisujemy
+// glMapBufferRange bez synchronizacji i osierocamy bufor, gdy dojdziemy do końca.
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Shader.h"
+#include "Vertex.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Układ std140: vec3 zajmuje tyle co vec4, więc trzymamy vec4
+struct FrameUniforms {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection; // projection * view - raz na klatkę zamiast mnożenia macierzy w każdym wierzchołku
+    glm::vec4 lightPos;
+    glm::vec4 viewPos;
+    glm::vec4 lightColor;
+    glm::vec4 clusterScale; // ClusteredLights: kafel = gl_FragCoord.xy * xy, plaster = log(głębokość) * z + w
+    glm::ivec4 clusterSize; // kafle X, kafle Y, plastry, liczba świateł
+};
+static_assert(sizeof(FrameUniforms) == 272, "FrameUniforms musi odpowiadac blokowi FrameData (std140)");
+
+struct DrawUniforms {
+    glm::mat4 model;
+    glm::vec4 objectColor;
+    glm::vec4 posOffset;   // dekwantyzacja pozycji: pos = posOffset + aPos * posScale
+    glm::vec4 posScale;
+    float tiling;
+    int textureRef;        // numer tekstury w TextureLibrary (wariant TEXTURED); lakier PAINT idzie z instancji
+    int compactVertex;
+    int instanced;         // 1 = macierz i macierz normalnych z instancji (atrybuty 4-11), model pomijany
+    glm::vec4 normalMatrix[3]; // mat3 w std140: kolumny jako vec4
+
+    // Model razem z jego macierzą normalnych
+    void setModel(const glm::mat4 &matrix) {
+        model = matrix;
+        writeNormalMatrix(normalMatrix, matrix);
+    }
+};
+static_assert(sizeof(DrawUniforms) == 176, "DrawUniforms musi odpowiadac blokowi DrawData (std140)");
+
+class UniformBuffers {
+public:
+    static constexpr GLuint FRAME_BINDING = 0;
+    static constexpr GLuint DRAW_BINDING = 1;
+    static constexpr size_t INITIAL_RING_BYTES = 1024 * 1024;
+
+    UniformBuffers() {
+        GLint alignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        stride = (sizeof(DrawUniforms) + alignment - 1) / alignment * alignment;
+
+        glGenBuffers(1, &frameBuffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, frameBuffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_STREAM_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_BINDING, frameBuffer);
+
+        glGenBuffers(1, &ringBuffer);
+        allocateRing(INITIAL_RING_BYTES);
+    }
+
+    ~UniformBuffers() {
+        glDeleteBuffers(1, &frameBuffer);
+        glDeleteBuffers(1, &ringBuffer);
+    }
+
+    UniformBuffers(const UniformBuffers&) = delete;
+    UniformBuffers& operator=(const UniformBuffers&) = delete;
+
+    // Po zlinkowaniu programu: przypisanie jego bloków do wspólnych punktów wiązania
+    static void attach(Shader &shader) {
+        shader.bindUniformBlock("FrameData", FRAME_BINDING);
+        shader.bindUniformBlock("DrawData", DRAW_BINDING);
+    }
+
+    // Raz na klatkę - osierocenie + jeden zapis
+    void setFrame(const FrameUniforms &frame) {
+        glBindBuffer(GL_UNIFORM_BUFFER, frameBuffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &frame);
+    }
+
+    // Zbieranie danych rysowań (tylko CPU); zwraca numer do bindDraw po upload()
+    size_t push(const DrawUniforms &draw) {
+        size_t index = pushed++;
+        staging.resize(pushed * stride);
+        std::memcpy(staging.data() + index * stride, &draw, sizeof(DrawUniforms));
+        return index;
+    }
+
+    // Wysłanie wszystkich zebranych rysowań jednym mapowaniem
+    void upload() {
+        size_t bytes = staging.size();
+        if(bytes == 0) return;
+        if(bytes > ringBytes) allocateRing(std::max(bytes, ringBytes * 2));
+
+        glBindBuffer(GL_UNIFORM_BUFFER, ringBuffer);
+        if(ringHead + bytes > ringBytes) {
+            // Koniec pierścienia: nowy magazyn dla bufora, GPU dokończy na starym
+            glBufferData(GL_UNIFORM_BUFFER, ringBytes, nullptr, GL_STREAM_DRAW);
+            ringHead = 0;
+        }
+        // Ten zakres nie był używany od ostatniego osierocenia - synchronizacja zbędna
+        void* target = glMapBufferRange(GL_UNIFORM_BUFFER, ringHead, bytes,
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if(target) {
+            std::memcpy(target, staging.data(), bytes);
+            glUnmapBuffer(GL_UNIFORM_BUFFER);
+        }
+        batchBase = ringHead;
+        ringHead += bytes;
+        uploadedDraws += pushed;
+
+        staging.clear();
+        pushed = 0;
+    }
+
+    void bindDraw(size_t index) {
+        glBindBufferRange(GL_UNIFORM_BUFFER, DRAW_BINDING, ringBuffer, batchBase + index * stride, sizeof(DrawUniforms));
+    }
+
+    // Ile rysowań przeszło przez pierścień od startu
+    uint64_t drawCount() const { return uploadedDraws; }
+
+private:
+    GLuint frameBuffer = 0;
+    GLuint ringBuffer = 0;
+    size_t ringBytes = 0;
+    size_t ringHead = 0;
+    size_t batchBase = 0;
+    size_t stride = 0;
+
+    std::vector<unsigned char> staging;
+    size_t pushed = 0;
+    uint64_t uploadedDraws = 0;
+
+    void allocateRing(size_t bytes) {
+        ringBytes = bytes;
+        ringHead = 0;
+        glBindBuffer(GL_UNIFORM_BUFFER, ringBuffer);
+        glBufferData(GL_UNIFORM_BUFFER, ringBytes, nullptr, GL_STREAM_DRAW);
+    }
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef VERTEX_H
+#define VERTEX_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+
+#include <cstdint>
+
+// Struktura reprezentująca jeden wierzchołek
+struct Vertex {
+    glm::vec3 Position;  // Gdzie jest?
+    glm::vec3 Normal;    // W którą stronę patrzy ściana? (do oświetlenia)
+    glm::vec2 TexCoords; // Jak nałożyć teksturę?
+};
+
+// Kompaktowy wierzchołek (16 bajtów zamiast 32) - opcja Mesh::useCompactVertices
+struct PackedVertex {
+    uint16_t Position[4];  // unorm16 względem AABB siatki (4. składowa to wyrównanie)
+    int16_t  Normal[2];    // normalna zakodowana oktaedrycznie, snorm16
+    uint16_t TexCoords[2]; // half float
+};
+
+// Macierz normalnych (odwrotność transponowana części 3x3) jako trzy kolumny vec4 - układ mat3 w std140/std430.
+// Liczona raz na rysowanie albo instancję zamiast inverse() w każdym wierzchołku.
+inline void writeNormalMatrix(glm::vec4 (&columns)[3], const glm::mat4 &transform) {
+    glm::mat3 normal = glm::inverseTranspose(glm::mat3(transform));
+    for(int c = 0; c < 3; c++) columns[c] = glm::vec4(normal[c], 0.0f);
+}
+
+// Dane jednej instancji auta (atrybuty z dzielnikiem 1): 4-7 macierz modelu, 8 warstwa lakieru,
+// 9-11 macierz normalnych. Układ = struktura Instance (std430) w shader_mdi.vert.
+struct InstanceData {
+    glm::mat4 Transform;
+    glm::vec4 NormalMatrix[3];
+    float     PaintLayer; // lakier - numer tekstury w TextureLibrary
+    float     Padding[3];
+
+    static InstanceData make(const glm::mat4 &transform, float paintLayer) {
+        InstanceData instance = { transform, {}, paintLayer, { 0.0f, 0.0f, 0.0f } };
+        writeNormalMatrix(instance.NormalMatrix, transform);
+        return instance;
+    }
+};
+static_assert(sizeof(InstanceData) == 128, "InstanceData musi odpowiadac strukturze Instance w shader_mdi.vert (std430)");
+
+#endif
@@ -1,51 +1,124 @@
 #version 330 core
+// Warianty (ShaderVariants.h): TEXTURED / PAINT / bez nich kolor, GLASS, EMISSIVE, TILING (w shader.vert)
 out vec4 FragColor;
 
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoord;
+flat in vec4 ObjectColor; // z DrawData albo z rekordu SSBO (shader_mdi.vert)
+flat in int TextureRef;   // numer w TextureLibrary: klasa rozmiaru * 256 + warstwa
 
-uniform sampler2D texture1;
-uniform vec3 objectColor;
-uniform int useTexture;
+#if defined(TEXTURED) || defined(PAINT)
+// Tablice TextureLibrary - po jednej na klasę rozmiaru, jednostki 0..2
+uniform sampler2DArray library256;
+uniform sampler2DArray library512;
+uniform sampler2DArray library1024;
+#endif
 
-uniform vec3 lightPos;  // Pozycja światła
-uniform vec3 viewPos;   // Pozycja kamery (do błysku)
-uniform vec3 lightColor;
+#ifndef EMISSIVE
+// Oświetlenie klastrowe (ClusteredLights.h) - bufory tekstur na jednostkach 3..5
+uniform samplerBuffer lightData;     // 3 teksele na światło: (pozycja, zasięg), (kolor, cos wewn.), (kierunek, cos zewn.)
+uniform usamplerBuffer clusterGrid;  // (początek, liczba) na klaster
+uniform usamplerBuffer lightIndices; // numery świateł kolejnych klastrów
+#endif
+
+// Siła i "shininess" błysku - stałe wariantu zamiast jednej wartości dla wszystkich powierzchni
+#ifdef GLASS
+const float specularStrength = 1.5; // szyby: mocny, mały odblask
+const float shininess = 128.0;
+#else
+const float specularStrength = 0.8; // Siła błysku (dla aut wysoka)
+const float shininess = 32.0;       // im wyższa liczba, tym mniejszy i ostrzejszy punkt światła
+#endif
+
+// Wspólny blok klatki (UniformBuffers.h)
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection; // projection * view policzone na CPU
+    vec4 lightPos;   // Pozycja światła
+    vec4 viewPos;    // Pozycja kamery (do błysku)
+    vec4 lightColor;
+    vec4 clusterScale; // Oświetlenie klastrowe (ClusteredLights.h)
+    ivec4 clusterSize;
+};
+
+vec4 baseColor() {
+#if defined(TEXTURED) || defined(PAINT)
+    // GLSL 3.30 nie indeksuje tablic samplerów zmienną - klasa wybiera sampler gałęzią (stała w całym rysowaniu/instancji)
+    int sizeClass = TextureRef / 256;
+    vec3 uv = vec3(TexCoord, float(TextureRef - sizeClass * 256));
+    if(sizeClass == 0) return texture(library256, uv);
+    if(sizeClass == 1) return texture(library512, uv);
+    return texture(library1024, uv);
+#else
+    return vec4(ObjectColor.rgb, 1.0);
+#endif
+}
+
+#ifndef EMISSIVE
+// Reflektory i listwy świetlne z klastra tego fragmentu (kafel ekranu + plaster głębokości)
+vec3 clusterLighting(vec3 norm, vec3 viewDir) {
+    float depth = max(-(view * vec4(FragPos, 1.0)).z, 1e-4);
+    ivec3 cell = ivec3(vec3(gl_FragCoord.xy * clusterScale.xy, log(depth) * clusterScale.z + clusterScale.w));
+    cell = clamp(cell, ivec3(0), clusterSize.xyz - 1);
+    int cluster = (cell.z * clusterSize.y + cell.y) * clusterSize.x + cell.x;
+    uvec2 range = texelFetch(clusterGrid, cluster).xy;
+
+    vec3 result = vec3(0.0);
+    for(uint i = 0u; i < range.y; i++) {
+        int light = int(texelFetch(lightIndices, int(range.x + i)).r) * 3;
+        vec4 positionRadius = texelFetch(lightData, light);
+        vec4 colorInner = texelFetch(lightData, light + 1);
+        vec4 directionOuter = texelFetch(lightData, light + 2);
+
+        vec3 toLight = positionRadius.xyz - FragPos;
+        float dist = length(toLight);
+        if(dist >= positionRadius.w) continue;
+        vec3 lightDir = toLight / dist;
+
+        // Odwrotność kwadratu odległości wygaszona do zera na granicy zasięgu (bez skoku na krawędzi klastra)
+        float fade = clamp(1.0 - pow(dist / positionRadius.w, 4.0), 0.0, 1.0);
+        float attenuation = fade * fade / (1.0 + dist * dist);
+        // Stożek reflektora; punktowe mają cos zewn. = -2, więc zawsze 1
+        attenuation *= smoothstep(directionOuter.w, colorInner.w, dot(-lightDir, directionOuter.xyz));
+
+        float diff = max(dot(norm, lightDir), 0.0);
+        float spec = pow(max(dot(viewDir, reflect(-lightDir, norm)), 0.0), shininess);
+        result += (diff + specularStrength * spec) * attenuation * colorInner.rgb;
+    }
+    return result;
+}
+#endif
 
 void main() {
+#ifdef EMISSIVE
+    // Lampy świecą własnym kolorem - oświetlenie ich nie przyciemnia
+    FragColor = baseColor();
+#else
     // 1. AMBIENT (Światło otoczenia)
     // Stałe, słabe światło, żeby cienie nie były idealnie czarne
     float ambientStrength = 0.4;
-    vec3 ambient = ambientStrength * lightColor;
+    vec3 ambient = ambientStrength * lightColor.rgb;
   	
     // 2. DIFFUSE (Światło rozproszone - TO JEST DYNAMICZNE OŚWIETLENIE)
     // Obliczamy kąt między normalną ściany a kierunkiem do światła
     vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(lightPos - FragPos);
+    vec3 lightDir = normalize(lightPos.xyz - FragPos);
     float diff = max(dot(norm, lightDir), 0.0); // Jeśli kąt > 90 stopni, to 0 (cień)
-    vec3 diffuse = diff * lightColor;
+    vec3 diffuse = diff * lightColor.rgb;
     
     // 3. SPECULAR (Błysk / Odblask)
     // Obliczamy odbicie światła w stronę kamery
-    float specularStrength = 0.8; // Siła błysku (dla aut wysoka)
-    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
     vec3 reflectDir = reflect(-lightDir, norm);  
-    // 32 to "shininess" - im wyższa liczba, tym mniejszy i ostrzejszy punkt światła
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32); 
-    vec3 specular = specularStrength * spec * lightColor;  
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess); 
+    vec3 specular = specularStrength * spec * lightColor.rgb;  
         
-    // Sumujemy składniki światła
-    vec3 lighting = (ambient + diffuse + specular);
-
-    // Pobieramy kolor obiektu (z tekstury lub koloru)
-    vec4 baseColor;
-    if(useTexture == 1) {
-        baseColor = texture(texture1, TexCoord);
-    } else {
-        baseColor = vec4(objectColor, 1.0);
-    }
+    // Sumujemy składniki światła (+ reflektory salonu z klastra)
+    vec3 lighting = (ambient + diffuse + specular) + clusterLighting(norm, viewDir);
 
-    // Mnożymy światło * kolor
-    FragColor = vec4(lighting, 1.0) * baseColor;
+    // Mnożymy światło * kolor (źródło koloru wybiera wariant)
+    FragColor = vec4(lighting, 1.0) * baseColor();
+#endif
 }
\ No newline at end of file
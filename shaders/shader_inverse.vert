@@ -0,0 +1,67 @@
+#version 330 core
+// Poprzedni shader.vert - macierz normalnych i projection * view liczone w każdym wierzchołku.
+// Tylko do porównania w "SalonBench --bench-normals" (src/bench.cpp); bloki uniformów zgodne z UniformBuffers.h.
+layout (location = 0) in vec3 aPos;       // float albo unorm16 względem AABB siatki
+layout (location = 1) in vec2 aTexCoord;  // float albo half float
+layout (location = 2) in vec3 aNormal;    // pełny format wierzchołka
+layout (location = 3) in vec2 aNormalOct; // kompaktowy format: normalna oktaedryczna (snorm16)
+layout (location = 4) in mat4 aInstanceModel; // instancja auta (4-7), dzielnik 1
+layout (location = 8) in float aPaintLayer;   // lakier instancji (numer w TextureLibrary)
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+flat out vec4 ObjectColor;
+flat out int TextureRef;
+
+// Wspólne bloki uniformów (UniformBuffers.h); materiał idzie do fragment shadera jako flat
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection; // tu nieużywane
+    vec4 lightPos;   // Pozycja światła
+    vec4 viewPos;    // Pozycja kamery (do błysku)
+    vec4 lightColor;
+    vec4 clusterScale; // Oświetlenie klastrowe (ClusteredLights.h)
+    ivec4 clusterSize;
+};
+
+layout (std140) uniform DrawData {
+    mat4 model;
+    vec4 objectColor;
+    vec4 posOffset;  // Dekwantyzacja pozycji (dla floatów: posOffset = 0, posScale = 1)
+    vec4 posScale;
+    float tiling;
+    int textureRef;     // numer tekstury w TextureLibrary (wariant TEXTURED)
+    int compactVertex;
+    int instanced;      // 1 = model * macierz instancji
+    mat3 normalMatrix;  // tu nieużywane
+};
+
+vec3 decodeOctahedral(vec2 e) {
+    vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
+
+void main() {
+    vec3 localPos = posOffset.xyz + aPos * posScale.xyz;
+    vec3 localNormal = compactVertex == 1 ? decodeOctahedral(aNormalOct) : aNormal;
+
+    // Instancja auta: macierz stanowiska z atrybutu (DrawData.model to wtedy jednostkowa)
+    mat4 world = instanced == 1 ? model * aInstanceModel : model;
+
+    // Obliczamy pozycję fragmentu w świecie 3D
+    FragPos = vec3(world * vec4(localPos, 1.0));
+    
+    // Obliczamy wektor normalny (poprawka na skalowanie modelu - WAŻNE!)
+    Normal = mat3(transpose(inverse(world))) * localNormal;  
+    
+    // Przekazujemy UV z tilingiem
+    TexCoord = aTexCoord * tiling;
+    ObjectColor = objectColor;
+    TextureRef = textureRef;
+    
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
\ No newline at end of file
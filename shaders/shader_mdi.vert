@@ -0,0 +1,91 @@
+#version 430 core
+// Wariant shader.vert dla ścieżki glMultiDrawElementsIndirect (IndirectDraw.h):
+// dane rysowania i instancje z buforów SSBO zamiast bloku DrawData i atrybutów 4-11.
+layout (location = 0) in vec3 aPos;       // float albo unorm16 względem AABB siatki
+layout (location = 1) in vec2 aTexCoord;  // float albo half float
+layout (location = 2) in vec3 aNormal;    // pełny format wierzchołka
+layout (location = 3) in vec2 aNormalOct; // kompaktowy format: normalna oktaedryczna (snorm16)
+layout (location = 12) in uint aDrawId;    // numer rekordu = baseInstance komendy (dzielnik 2^30)
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+flat out vec4 ObjectColor;
+flat out int TextureRef;
+
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection; // projection * view policzone na CPU
+    vec4 lightPos;   // Pozycja światła
+    vec4 viewPos;    // Pozycja kamery (do błysku)
+    vec4 lightColor;
+    vec4 clusterScale; // Oświetlenie klastrowe (ClusteredLights.h)
+    ivec4 clusterSize;
+};
+
+// DrawUniforms + numer pierwszej instancji (DrawRecord, std430)
+struct DrawRecord {
+    mat4 model;
+    vec4 objectColor;
+    vec4 posOffset;
+    vec4 posScale;
+    float tiling;
+    int textureRef;     // numer tekstury w TextureLibrary (wariant TEXTURED)
+    int compactVertex;
+    int instanced;      // 1 = macierze z instancji, model pomijany
+    mat3 normalMatrix;  // odwrotność transponowana modelu
+    uint firstInstance;
+};
+
+struct Instance {
+    mat4 transform;
+    mat3 normalMatrix; // odwrotność transponowana transform (InstanceData::make)
+    vec4 paintLayer;   // x = lakier (numer w TextureLibrary)
+};
+
+layout (std430, binding = 2) readonly buffer DrawRecords {
+    DrawRecord draws[];
+};
+
+layout (std430, binding = 3) readonly buffer Instances {
+    Instance instances[];
+};
+
+vec3 decodeOctahedral(vec2 e) {
+    vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
+
+void main() {
+    DrawRecord draw = draws[aDrawId];
+
+    vec3 localPos = draw.posOffset.xyz + aPos * draw.posScale.xyz;
+    vec3 localNormal = draw.compactVertex == 1 ? decodeOctahedral(aNormalOct) : aNormal;
+
+    mat4 world = draw.model;
+    mat3 normalWorld = draw.normalMatrix;
+    int textureRef = draw.textureRef;
+    if (draw.instanced == 1) {
+        Instance instance = instances[draw.firstInstance + uint(gl_InstanceID)];
+        world = instance.transform;
+        normalWorld = instance.normalMatrix;
+#ifdef PAINT
+        textureRef = int(instance.paintLayer.x); // lakier stanowiska
+#endif
+    }
+
+    FragPos = vec3(world * vec4(localPos, 1.0));
+    Normal = normalWorld * localNormal;
+#ifdef TILING
+    TexCoord = aTexCoord * draw.tiling;
+#else
+    TexCoord = aTexCoord;
+#endif
+    ObjectColor = draw.objectColor;
+    TextureRef = textureRef;
+
+    gl_Position = viewProjection * vec4(FragPos, 1.0);
+}
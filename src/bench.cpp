@@ -0,0 +1,528 @@
+// SalonBench - benchmarki i samosprawdzenia poza aplikacją (osobny program, te same nagłówki co SalonApp).
+// main.cpp zostaje przy scenie i pętli klatek; tu trafiają tryby, które mierzą albo sprawdzają jeden moduł.
+//
+//   SalonBench --bench-obj        import car-N.obj: Assimp vs ObjParser (1 wątek i wszystkie)
+//   SalonBench --bench-bvh        BVH stanowisk (10 / 1k / 100k aut) i trójkątów car-N.obj: budowa, refit, zapytania
+//   SalonBench --bench-lights     przypisanie świateł do klastrów przy 10, 100 i 1000 stanowiskach (1 wątek vs pula)
+//   SalonBench --test-occlusion   samosprawdzenie programowego bufora głębokości (kod wyjścia 1 = błąd)
+//   SalonBench --bench-normals    etap wierzchołków: inverse() w shaderze vs macierz normalnych z CPU (ukryte okno GL)
+//   SalonBench --bench-shaders    zimny vs ciepły start programów (ProgramCache), kompilacja po kolei vs równoległa
+
+#include <glad/glad.h>
+#include <GL/freeglut.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ClusteredLights.h"
+#include "GLExtensions.h"
+#include "InstanceBuffer.h"
+#include "MaterialRules.h"
+#include "Model.h"
+#include "ObjParser.h"
+#include "OcclusionCuller.h"
+#include "ProgramCache.h"
+#include "ShaderVariants.h"
+#include "ShowroomLayout.h"
+#include "UniformBuffers.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+// Rozmiar ukrytego okna benchmarków GPU - jak domyślne okno aplikacji (proporcje projekcji)
+const int BENCH_WIDTH = 1200;
+const int BENCH_HEIGHT = 800;
+
+// Najlepszy z kilku przebiegów - bez wpływu zimnego cache dysku
+double bestOfRuns(const std::function<bool()> &run) {
+    const int RUNS = 5;
+    double best = 1e30;
+    for(int r = 0; r < RUNS; r++) {
+        auto start = std::chrono::steady_clock::now();
+        if(!run()) return -1.0;
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+// Sam import (bez optymalizacji i LOD): Assimp (triangulacja, spawanie, gładkie normalne) vs ObjParser
+void benchmarkObjParser() {
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "Plik            Assimp [ms]  ObjParser 1 watek [ms]  ObjParser " << threads << " watkow [ms]  trojkaty" << std::endl;
+    for(int i = 1; i <= CAR_COUNT; i++) {
+        std::string path = "models/car-" + std::to_string(i) + ".obj";
+        if(!std::filesystem::exists(path)) continue;
+
+        size_t triangles = 0;
+        double assimpMs = bestOfRuns([&] {
+            Assimp::Importer importer;
+            return importer.ReadFile(path, aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_GenSmoothNormals) != nullptr;
+        });
+        double singleMs = bestOfRuns([&] {
+            std::vector<MeshData> meshes;
+            return ObjParser::load(path, meshes, 1);
+        });
+        double parallelMs = bestOfRuns([&] {
+            std::vector<MeshData> meshes;
+            bool ok = ObjParser::load(path, meshes, threads);
+            triangles = 0;
+            for(const MeshData &mesh : meshes) triangles += mesh.indices.size() / 3;
+            return ok;
+        });
+
+        std::cout << path << "  " << assimpMs << "  " << singleMs << " (" << assimpMs / singleMs << "x)  "
+                  << parallelMs << " (" << assimpMs / parallelMs << "x)  " << triangles << std::endl;
+    }
+}
+
+// BVH stanowisk (10 / 1k / 100k aut w rzędach salonu) i BVH trójkątów siatek car-N.obj:
+// budowa, refit po przestawieniu wszystkich aut i przepustowość zapytań w porównaniu z przeglądem liniowym
+void benchmarkBvh() {
+    const int QUERIES = 1000;
+    const glm::vec3 half(0.9f, 0.66f, 2.0f); // typowe auto po skali stanowiska
+    std::cout << "Auta     budowa [ms]  refit [ms]  frustum [zap/s]  promien [zap/s] (liniowo)  najblizsze [zap/s] (liniowo)" << std::endl;
+    for(int count : { 10, 1000, 100000 }) {
+        std::vector<glm::mat4> transforms(count);
+        std::vector<Aabb> boxes(count);
+        for(int i = 0; i < count; i++) {
+            glm::mat4 m = glm::translate(glm::mat4(1.0f), glm::vec3((i % ROW_LENGTH) * carSpacing, 0.0f, -(i / ROW_LENGTH) * ROW_SPACING));
+            transforms[i] = glm::rotate(m, glm::radians(static_cast<float>(i * 37 % 360)), glm::vec3(0.0f, 1.0f, 0.0f));
+            boxes[i] = Aabb::transformed(transforms[i], -half, half);
+        }
+        float depth = (count / ROW_LENGTH) * ROW_SPACING;
+        // Przegląd liniowy przy 100k aut jest wolny - mniej zapytań, wynik i tak na sekundę
+        int queries = std::min(QUERIES, 20000000 / count);
+
+        Bvh bvh;
+        double buildMs = bestOfRuns([&] { bvh.build(boxes); return true; });
+        for(int i = 0; i < count; i++)
+            boxes[i] = Aabb::transformed(glm::translate(transforms[i], glm::vec3(0.3f, 0.0f, 0.0f)), -half, half);
+        double refitMs = bestOfRuns([&] { bvh.refit(boxes); return true; });
+
+        // Kamery i promienie wzdłuż salonu, na wysokości oczu
+        std::vector<glm::vec3> origins(queries), directions(queries);
+        for(int q = 0; q < queries; q++) {
+            origins[q] = glm::vec3((q % ROW_LENGTH) * carSpacing, 1.7f, -depth * q / queries);
+            float angle = q * 2.399963f;
+            directions[q] = glm::normalize(glm::vec3(std::cos(angle), -0.05f, std::sin(angle)));
+        }
+        size_t checksum = 0;
+        double frustumMs = bestOfRuns([&] {
+            for(int q = 0; q < queries; q++) {
+                glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f) *
+                                           glm::lookAt(origins[q], origins[q] + directions[q], glm::vec3(0.0f, 1.0f, 0.0f));
+                bvh.frustum(Frustum::fromMatrix(viewProjection), [&](uint32_t, bool) { checksum++; });
+            }
+            return true;
+        });
+        auto rayQuery = [&](bool linear) {
+            return bestOfRuns([&] {
+                for(int q = 0; q < queries; q++) {
+                    glm::vec3 invDir = 1.0f / directions[q];
+                    float distance = FLT_MAX;
+                    if(linear) {
+                        for(const Aabb &box : boxes) distance = std::min(distance, box.intersect(origins[q], invDir, distance));
+                    } else {
+                        bvh.raycast(origins[q], directions[q], distance, [&](uint32_t i, float maxT) { return boxes[i].intersect(origins[q], invDir, maxT); });
+                    }
+                    checksum += distance < FLT_MAX;
+                }
+                return true;
+            });
+        };
+        auto nearestQuery = [&](bool linear) {
+            return bestOfRuns([&] {
+                for(int q = 0; q < queries; q++) {
+                    float best = FLT_MAX;
+                    if(linear) {
+                        for(const Aabb &box : boxes) best = std::min(best, box.distanceSquared(origins[q]));
+                    } else {
+                        bvh.nearest(origins[q], best, [&](uint32_t i) { return boxes[i].distanceSquared(origins[q]); });
+                    }
+                    checksum += best < 1.0f;
+                }
+                return true;
+            });
+        };
+        double rayMs = rayQuery(false), rayLinearMs = rayQuery(true);
+        double nearestMs = nearestQuery(false), nearestLinearMs = nearestQuery(true);
+        auto perSecond = [&](double ms) { return static_cast<long long>(queries * 1000.0 / std::max(ms, 1e-6)); };
+        std::cout << count << "  " << buildMs << "  " << refitMs << "  " << perSecond(frustumMs) << "  "
+                  << perSecond(rayMs) << " (" << perSecond(rayLinearMs) << ")  "
+                  << perSecond(nearestMs) << " (" << perSecond(nearestLinearMs) << ")  [" << checksum << "]" << std::endl;
+    }
+
+    std::cout << "Plik            trojkaty  budowa BVH [ms]  promien [zap/s]" << std::endl;
+    for(int i = 1; i <= CAR_COUNT; i++) {
+        std::string path = "models/car-" + std::to_string(i) + ".obj";
+        std::vector<MeshData> meshes;
+        if(!std::filesystem::exists(path) || !ObjParser::load(path, meshes, std::thread::hardware_concurrency())) continue;
+
+        std::vector<TriangleBvh> bvhs(meshes.size());
+        size_t triangles = 0;
+        glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+        for(const MeshData &mesh : meshes) {
+            triangles += mesh.indices.size() / 3;
+            for(const Vertex &vertex : mesh.vertices) {
+                boundsMin = glm::min(boundsMin, vertex.Position);
+                boundsMax = glm::max(boundsMax, vertex.Position);
+            }
+        }
+        double buildMs = bestOfRuns([&] {
+            for(size_t m = 0; m < meshes.size(); m++)
+                bvhs[m].build(meshes[m].vertices.data(), meshes[m].indices.data(), meshes[m].indices.size());
+            return true;
+        });
+        // Promienie z zewnątrz w stronę środka modelu
+        glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+        float radius = glm::length(boundsMax - boundsMin);
+        size_t hits = 0;
+        double rayMs = bestOfRuns([&] {
+            for(int q = 0; q < QUERIES; q++) {
+                float angle = q * 2.399963f;
+                glm::vec3 origin = center + radius * glm::vec3(std::cos(angle), 0.3f, std::sin(angle));
+                glm::vec3 direction = center + (boundsMax - boundsMin) * 0.2f * glm::vec3(std::sin(q * 0.7f), std::cos(q * 1.3f), 0.0f) - origin;
+                float best = FLT_MAX;
+                for(const TriangleBvh &bvh : bvhs) best = std::min(best, bvh.raycast(origin, direction));
+                hits += best < FLT_MAX;
+            }
+            return true;
+        });
+        std::cout << path << "  " << triangles << "  " << buildMs << "  "
+                  << static_cast<long long>(QUERIES * 1000.0 / std::max(rayMs, 1e-6)) << "  [trafien " << hits << "]" << std::endl;
+    }
+}
+
+// Przypisanie świateł salonu (showroomLights) do klastrów z kamery przy wejściu: jeden wątek vs wątek
+// główny + pula, średnio i najwięcej świateł na klaster (= pętla fragment shadera); bez okna i GL
+void benchmarkClusteredLights() {
+    const int FRAMES = 20;
+    ThreadPool pool;
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, PLAYER_HEIGHT, 5.0f), glm::vec3(0.0f, PLAYER_HEIGHT, -5.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    std::cout << "Stanowiska  swiatla  widoczne  1 watek [us]  " << pool.size() + 1 << " watkow [us]  srednio/klaster  max/klaster  pominiete" << std::endl;
+    for(int count : { 10, 100, 1000 }) {
+        std::vector<glm::vec3> slotPositions;
+        for(int i = 0; i < count; i++) slotPositions.push_back(slotPosition(i, count));
+        std::vector<Light> lights = showroomLights(slotPositions, 10.0f * floorScaleFor(count));
+
+        ClusteredLights single(nullptr), parallel(&pool);
+        single.setLights(lights);
+        parallel.setLights(lights);
+        double microseconds[2];
+        ClusteredLights* variants[2] = { &single, &parallel };
+        for(int v = 0; v < 2; v++) {
+            double best = 1e30;
+            for(int f = 0; f < FRAMES; f++) {
+                variants[v]->assign(view, glm::radians(45.0f), 1.5f, 0.1f, 100.0f);
+                best = std::min(best, variants[v]->stats().assignMicroseconds);
+            }
+            microseconds[v] = best;
+        }
+
+        // Oba przebiegi muszą dać te same listy
+        bool same = true;
+        for(int c = 0; c < ClusteredLights::CLUSTERS && same; c++)
+            same = single.clusterCount(c) == parallel.clusterCount(c) &&
+                   std::equal(single.clusterLights(c), single.clusterLights(c) + single.clusterCount(c), parallel.clusterLights(c));
+        const ClusteredLights::Stats &stats = parallel.stats();
+        std::cout << count << "  " << stats.lights << "  " << stats.visibleLights << "  " << microseconds[0] << "  " << microseconds[1] << "  "
+                  << (stats.occupiedClusters ? static_cast<double>(stats.references) / stats.occupiedClusters : 0.0) << "  "
+                  << stats.maxPerCluster << "  " << stats.overflow << (same ? "" : "  [BLAD: rozne listy]") << std::endl;
+    }
+}
+
+// Samosprawdzenie OcclusionCuller na syntetycznych scenach (bez okna i GL); kod wyjścia 1 = błąd
+bool testOcclusionCuller() {
+    glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 2.0f, 0.1f, 100.0f) *
+                               glm::lookAt(glm::vec3(0.0f, 1.0f, 10.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    auto box = [](glm::vec3 center, glm::vec3 half) {
+        Aabb b;
+        b.min = center - half;
+        b.max = center + half;
+        return b;
+    };
+    Aabb wall = box(glm::vec3(0.0f, 1.0f, 2.0f), glm::vec3(3.0f, 2.0f, 0.1f));
+
+    int failures = 0;
+    auto check = [&](const char* name, bool ok) {
+        std::cout << (ok ? "OK    " : "BLAD  ") << name << std::endl;
+        if(!ok) failures++;
+    };
+
+    ThreadPool pool(3);
+    for(ThreadPool* threads : { static_cast<ThreadPool*>(nullptr), &pool }) {
+        OcclusionCuller culler(threads);
+        culler.begin(viewProjection);
+        culler.addOccluder(glm::mat4(1.0f), wall);
+        culler.rasterize();
+        std::cout << (threads ? "-- watki puli + glowny" : "-- jeden watek") << std::endl;
+        check("auto za sciana jest zasloniete", !culler.visible(box(glm::vec3(0.0f, 1.0f, -3.0f), glm::vec3(0.9f, 0.7f, 2.0f))));
+        check("auto przed sciana jest widoczne", culler.visible(box(glm::vec3(0.0f, 1.0f, 5.0f), glm::vec3(0.9f, 0.7f, 2.0f))));
+        check("auto obok sciany jest widoczne", culler.visible(box(glm::vec3(12.0f, 1.0f, -3.0f), glm::vec3(0.9f, 0.7f, 2.0f))));
+        check("auto wystajace nad sciane jest widoczne", culler.visible(box(glm::vec3(0.0f, 4.0f, -3.0f), glm::vec3(0.9f, 1.0f, 2.0f))));
+        check("auto przecinajace sciane jest widoczne", culler.visible(box(glm::vec3(0.0f, 1.0f, 2.0f), glm::vec3(0.5f, 0.5f, 1.0f))));
+        check("auto przy kamerze jest widoczne", culler.visible(box(glm::vec3(0.0f, 1.0f, 10.0f), glm::vec3(0.9f, 0.7f, 2.0f))));
+        check("statystyki: 1 okluder, 6 testow, 1 zasloniete",
+              culler.stats().occluders == 1 && culler.stats().tested == 6 && culler.stats().occluded == 1);
+
+        // Okluder za kamerą nie może niczego zasłonić
+        culler.begin(viewProjection);
+        culler.addOccluder(glm::mat4(1.0f), box(glm::vec3(0.0f, 1.0f, 20.0f), glm::vec3(3.0f, 2.0f, 0.1f)));
+        culler.rasterize();
+        check("okluder za kamera nic nie zaslania", culler.visible(box(glm::vec3(0.0f, 1.0f, -3.0f), glm::vec3(0.9f, 0.7f, 2.0f))));
+    }
+
+    // Ten sam bufor głębokości niezależnie od liczby wątków (rząd aut jako okludery)
+    OcclusionCuller single(nullptr), parallel(&pool);
+    for(OcclusionCuller* culler : { &single, &parallel }) {
+        culler->begin(viewProjection);
+        for(int i = -4; i <= 4; i++)
+            culler->addOccluder(glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(i * 2.5f, 0.7f, 0.0f)), 0.3f * i, glm::vec3(0.0f, 1.0f, 0.0f)),
+                                box(glm::vec3(0.0f), glm::vec3(0.8f, 0.6f, 1.8f)));
+        culler->rasterize();
+    }
+    check("bufor glebokosci jednakowy dla 1 i wielu watkow", single.depthBuffer() == parallel.depthBuffer());
+
+    // Okluder zamkniętej siatki (pudełko 2x1x4 z trójkątów) mieści się w niej i nie jest zdegenerowany
+    std::vector<Vertex> vertices(8);
+    for(int c = 0; c < 8; c++)
+        vertices[c].Position = glm::vec3((c & 4) ? 1.0f : -1.0f, (c & 2) ? 0.5f : -0.5f, (c & 1) ? 2.0f : -2.0f);
+    std::vector<unsigned int> indices = { 0,1,3, 0,3,2, 4,6,7, 4,7,5, 0,4,5, 0,5,1, 2,3,7, 2,7,6, 0,2,6, 0,6,4, 1,5,7, 1,7,3 };
+    TriangleBvh closed;
+    closed.build(vertices.data(), indices.data(), indices.size());
+    Aabb hull = OcclusionCuller::buildHull({ &closed });
+    check("okluder pudelka lezy w jego wnetrzu", hull.valid() && hull.min.x >= -1.0f && hull.max.x <= 1.0f &&
+          hull.min.y >= -0.5f && hull.max.y <= 0.5f && hull.min.z >= -2.0f && hull.max.z <= 2.0f);
+    check("okluder pudelka zajmuje wiekszosc objetosci", hull.valid() &&
+          (hull.max.x - hull.min.x) * (hull.max.y - hull.min.y) * (hull.max.z - hull.min.z) > 0.8f * 2.0f * 1.0f * 4.0f);
+
+    // Sama płaszczyzna (bez wnętrza) nie daje okludera
+    std::vector<unsigned int> plane = { 0,4,5, 0,5,1 };
+    TriangleBvh flat;
+    flat.build(vertices.data(), plane.data(), plane.size());
+    check("plaska siatka nie ma okludera", !OcclusionCuller::buildHull({ &flat }).valid());
+
+    std::cout << (failures ? "Bledow: " + std::to_string(failures) : std::string("Wszystko OK")) << std::endl;
+    return failures == 0;
+}
+
+// Koszt etapu wierzchołków car-2 przed i po przeniesieniu macierzy normalnych na CPU: te same instancje
+// rysowane z GL_RASTERIZER_DISCARD (bez rasteryzacji i fragmentów), czas z zapytań GL_TIME_ELAPSED
+void benchmarkNormalMatrix() {
+    const int INSTANCES = 512;
+    const int FRAMES = 50;
+    Model car("models/car-2.obj");
+    if(car.meshes.empty()) {
+        std::cout << "Brak models/car-2.obj" << std::endl;
+        return;
+    }
+
+    UniformBuffers uniformBuffers;
+    InstanceBuffer instanceBuffer;
+    // Ten sam wariant co podłoga w aplikacji; "before" to stary etap wierzchołków z inverse() w shaderze
+    Shader before("shaders/shader_inverse.vert", "shaders/shader.frag", ShaderVariants::defines(SHADER_TEXTURED | SHADER_TILING));
+    Shader after("shaders/shader.vert", "shaders/shader.frag", ShaderVariants::defines(SHADER_TEXTURED | SHADER_TILING));
+    UniformBuffers::attach(before);
+    UniformBuffers::attach(after);
+
+    // Stanowiska w rzędach salonu, z obrotem i lekko niejednorodną skalą (jak pudełka zastępcze)
+    std::vector<InstanceData> instances;
+    for(int i = 0; i < INSTANCES; i++) {
+        glm::mat4 m = glm::translate(glm::mat4(1.0f), glm::vec3((i % ROW_LENGTH) * carSpacing, 0.0f, -(i / ROW_LENGTH) * ROW_SPACING));
+        m = glm::rotate(m, glm::radians(static_cast<float>(i * 37 % 360)), glm::vec3(0.0f, 1.0f, 0.0f));
+        instances.push_back(InstanceData::make(glm::scale(m, glm::vec3(1.0f, 1.0f + (i % 3) * 0.05f, 1.0f)), 0.0f));
+    }
+
+    FrameUniforms frame;
+    frame.view = glm::lookAt(glm::vec3(15.0f, 10.0f, 20.0f), glm::vec3(15.0f, 0.0f, -50.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    frame.projection = glm::perspective(glm::radians(45.0f), (float)BENCH_WIDTH / (float)BENCH_HEIGHT, 0.1f, 100.0f);
+    frame.viewProjection = frame.projection * frame.view;
+    frame.lightPos = glm::vec4(0.0f, 20.0f, 0.0f, 1.0f);
+    frame.viewPos = glm::vec4(15.0f, 10.0f, 20.0f, 1.0f);
+    frame.lightColor = glm::vec4(1.0f);
+    uniformBuffers.setFrame(frame);
+
+    size_t vertices = 0;
+    for(const Mesh &mesh : car.meshes) vertices += mesh.indexCount; // górna granica wywołań shadera (bez cache post-transform)
+    vertices *= INSTANCES;
+
+    GLuint query;
+    glGenQueries(1, &query);
+    glEnable(GL_RASTERIZER_DISCARD);
+
+    auto measure = [&](Shader &shader) {
+        shader.use();
+        double best = 1e30;
+        for(int frameIndex = 0; frameIndex < FRAMES + 5; frameIndex++) {
+            for(const InstanceData &instance : instances) instanceBuffer.push(instance);
+            instanceBuffer.upload();
+            std::vector<size_t> draws;
+            for(const Mesh &mesh : car.meshes) {
+                DrawUniforms draw;
+                draw.setModel(glm::mat4(1.0f));
+                draw.objectColor = glm::vec4(1.0f);
+                draw.posOffset = glm::vec4(mesh.positionOffset(), 0.0f);
+                draw.posScale = glm::vec4(mesh.positionScale(), 0.0f);
+                draw.tiling = mesh.material.tiling;
+                draw.textureRef = 0;
+                draw.compactVertex = mesh.compact ? 1 : 0;
+                draw.instanced = 1;
+                draws.push_back(uniformBuffers.push(draw));
+            }
+            uniformBuffers.upload();
+
+            glBeginQuery(GL_TIME_ELAPSED, query);
+            for(size_t m = 0; m < car.meshes.size(); m++) {
+                const Mesh &mesh = car.meshes[m];
+                uniformBuffers.bindDraw(draws[m]);
+                GeometryArena::bindVertexArray(mesh.arena->vertexArray());
+                mesh.arena->bindInstances(instanceBuffer.id(), 0);
+                mesh.drawElementsInstanced(INSTANCES);
+            }
+            glEndQuery(GL_TIME_ELAPSED);
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+            if(frameIndex >= 5) best = std::min(best, nanoseconds / 1e6); // pierwsze klatki to rozgrzewka
+        }
+        return best;
+    };
+
+    double inverseMs = measure(before);
+    double cpuMs = measure(after);
+    glDisable(GL_RASTERIZER_DISCARD);
+    glDeleteQueries(1, &query);
+
+    std::cout << "car-2 x " << INSTANCES << ": " << car.meshes.size() << " siatek, " << vertices << " indeksow na klatke" << std::endl;
+    std::cout << "inverse() w shaderze:          " << inverseMs << " ms (" << inverseMs * 1e6 / vertices << " ns/indeks)" << std::endl;
+    std::cout << "macierz normalnych z CPU:      " << cpuMs << " ms (" << cpuMs * 1e6 / vertices << " ns/indeks)" << std::endl;
+    std::cout << "Przyspieszenie etapu wierzcholkow: x" << inverseMs / cpuMs << std::endl;
+}
+
+// Zimny start (kompilacja ze źródeł, zapis binarek) vs ciepły (glProgramBinary) dla każdego programu,
+// który aplikacja buduje przy starcie: wariant podłogi, warianty z reguł materiałów i pudełko zastępcze
+void benchmarkShaderCache() {
+    if(!ProgramCache::enabled) {
+        std::cout << "Sterownik nie udostepnia binarek programow - zostaje kompilacja ze zrodel" << std::endl;
+        return;
+    }
+    MaterialRules rules;
+    rules.load("models/materials.txt");
+    std::vector<uint32_t> variants = rules.shaderFeatures();
+    variants.push_back(0);
+    variants.push_back(SHADER_TEXTURED | SHADER_TILING);
+
+    std::vector<std::string> vertexPaths = { "shaders/shader.vert" };
+    if(hasGLVersion(4, 3)) vertexPaths.push_back("shaders/shader_mdi.vert");
+
+    // Przebieg 0: pusty katalog cache, przebieg 1: wszystko z binarek zapisanych w przebiegu 0
+    ProgramCache::clear();
+    std::vector<double> times[2];
+    std::vector<bool> cached;
+    for(int pass = 0; pass < 2; pass++)
+        for(const std::string &vertexPath : vertexPaths)
+            for(uint32_t features : variants) {
+                Shader shader(vertexPath.c_str(), "shaders/shader.frag", ShaderVariants::defines(features));
+                times[pass].push_back(shader.buildMilliseconds);
+                if(pass == 1) cached.push_back(shader.fromBinaryCache);
+            }
+
+    std::cout << "Program                                     zimny [ms]  cieply [ms]" << std::endl;
+    double total[2] = { 0.0, 0.0 };
+    size_t i = 0;
+    for(const std::string &vertexPath : vertexPaths)
+        for(uint32_t features : variants) {
+            std::cout << vertexPath << " [" << ShaderVariants::describe(features) << "]  " << times[0][i] << "  " << times[1][i]
+                      << (cached[i] ? "" : "  (binarka odrzucona - kompilacja)") << std::endl;
+            total[0] += times[0][i];
+            total[1] += times[1][i];
+            i++;
+        }
+    std::cout << "Razem: " << total[0] << " ms -> " << total[1] << " ms (x" << total[0] / std::max(total[1], 1e-3) << ")" << std::endl;
+
+    // Te same programy bez binarek: kompilacja po kolei (stan po każdym) vs wszystkie zlecone naraz i odpytywane.
+    // Znacznik przebiegu w źródłach omija cache shaderów sterownika między przebiegami.
+    if(parallelShaderCompile) {
+        ProgramCache::enabled = false;
+        double wall[2];
+        for(int pass = 0; pass < 2; pass++) {
+            std::string marker = "#define BENCH_PASS_" + std::to_string(pass) + "_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "\n";
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::unique_ptr<Shader>> shaders;
+            for(const std::string &vertexPath : vertexPaths)
+                for(uint32_t features : variants)
+                    shaders.emplace_back(new Shader(vertexPath.c_str(), "shaders/shader.frag", ShaderVariants::defines(features) + marker, pass == 1));
+            for(bool all = false; !all; ) {
+                all = true;
+                for(std::unique_ptr<Shader> &shader : shaders) all = shader->ready() && all;
+            }
+            wall[pass] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        ProgramCache::enabled = true;
+        std::cout << "Kompilacja wszystkich ze zrodel: po kolei " << wall[0] << " ms, rownolegle (KHR_parallel_shader_compile) " << wall[1] << " ms" << std::endl;
+    } else {
+        std::cout << "Brak KHR_parallel_shader_compile - kompilacja programow po kolei" << std::endl;
+    }
+    std::cout << "Uwaga: sterownik moze miec wlasny cache shaderow (Mesa: MESA_SHADER_CACHE_DISABLE=true), ktory zaniza czas zimny" << std::endl;
+}
+
+// Ukryte okno GLUT tylko dla kontekstu GL (benchmarki etapów GPU); false = brak kontekstu
+bool createContext(int &argc, char** argv) {
+    glutInit(&argc, argv);
+    glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA | GLUT_DEPTH);
+    glutInitWindowSize(BENCH_WIDTH, BENCH_HEIGHT);
+    glutCreateWindow("SalonBench");
+    glutHideWindow();
+    if(!gladLoadGL()) return false;
+    glEnable(GL_DEPTH_TEST);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if(argc > 1 && std::strcmp(argv[1], "--bench-obj") == 0) {
+        benchmarkObjParser();
+        return 0;
+    }
+    if(argc > 1 && std::strcmp(argv[1], "--bench-bvh") == 0) {
+        benchmarkBvh();
+        return 0;
+    }
+    if(argc > 1 && std::strcmp(argv[1], "--bench-lights") == 0) {
+        benchmarkClusteredLights();
+        return 0;
+    }
+    if(argc > 1 && std::strcmp(argv[1], "--test-occlusion") == 0)
+        return testOcclusionCuller() ? 0 : 1;
+
+    // Dalej tylko tryby mierzące GPU
+    if(argc > 1 && std::strcmp(argv[1], "--bench-normals") == 0) {
+        if(!createContext(argc, argv)) return 1;
+        benchmarkNormalMatrix();
+        GeometryArena::releaseAll();
+        return 0;
+    }
+    if(argc > 1 && std::strcmp(argv[1], "--bench-shaders") == 0) {
+        if(!createContext(argc, argv)) return 1;
+        ProgramCache::init();
+        loadParallelShaderCompile();
+        benchmarkShaderCache();
+        return 0;
+    }
+
+    std::cout << "Uzycie: SalonBench --bench-obj | --bench-bvh | --bench-lights | --test-occlusion | --bench-normals | --bench-shaders" << std::endl;
+    return 1;
+}
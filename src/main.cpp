@@ -7,9 +7,25 @@
 
 #include <iostream>
 #include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <chrono>
 
 #include "Shader.h"
 #include "Model.h"
+#include "ModelLoader.h"
+#include "CarResidency.h"
+#include "ClusteredLights.h"
+#include "FrustumCuller.h"
+#include "IndirectDraw.h"
+#include "OcclusionCuller.h"
+#include "InstanceBuffer.h"
+#include "RenderQueue.h"
+#include "ShaderVariants.h"
+#include "ShowroomLayout.h"
+#include "TextureLibrary.h"
+#include "UniformBuffers.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -19,8 +35,7 @@ int windowWidth = 1200;
 int windowHeight = 800;
 
 // --- KAMERA ---
-// Ustawiamy sztywną wysokość "oczu" (np. 1.7 metra - wzrost człowieka)
-const float PLAYER_HEIGHT = 1.7f;
+// Sztywna wysokość "oczu" - PLAYER_HEIGHT (ShowroomLayout.h)
 
 glm::vec3 cameraPos   = glm::vec3(0.0f, PLAYER_HEIGHT, 5.0f);
 glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
@@ -42,56 +57,61 @@ bool isWireframe = false;
 
 unsigned int VAO, VBO;
 
-unsigned int floorTexture;
-unsigned int tireTexture;
-unsigned int steelTexture;
-unsigned int glassTexture;
-unsigned int redTexture;
-unsigned int blackTexture;
-unsigned int lightTexture;
-
-Shader* ourShader = nullptr;
-
-std::vector<Model*> carModels;
-std::vector<unsigned int> assignedPaints;
-
-// Konfiguracja
-const int CAR_COUNT = 5; // Ile aut chcemy wczytać?
-float carSpacing = 3.0f; // Odstęp między autami (w metrach)
-
-unsigned int loadTexture(const char* path) {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrChannels;
-    // OpenGL ma 0,0 na dole, a obrazki na górze - musimy obrócić
-    stbi_set_flip_vertically_on_load(true); 
-    unsigned char *data = stbi_load(path, &width, &height, &nrChannels, 0);
-    
-    if (data) {
-        GLenum format;
-        if (nrChannels == 1) format = GL_RED;
-        else if (nrChannels == 3) format = GL_RGB; // .jpg zazwyczaj
-        else if (nrChannels == 4) format = GL_RGBA; // .png zazwyczaj
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        // Ustawienia powtarzania (GL_REPEAT) i filtrowania
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    } else {
-        std::cout << "Nie udalo sie wczytac tekstury: " << path << std::endl;
-        stbi_image_free(data);
-    }
-
-    return textureID;
-}
+// Numery w TextureLibrary: podłoga, tekstura każdej klasy materiału (Paint bierze lakier stanowiska)
+// i lakiery car_paint_N (indeks N-1 = Slot::paintLayer)
+int floorTextureRef = 0;
+int materialTextureRefs[static_cast<int>(MaterialClass::Count)] = {};
+std::vector<int> paintTextureRefs;
+MaterialRules materialRules;
+
+// Bloki FrameData / DrawData (UBO) - jeden zapis kamery i jedno mapowanie danych rysowań na klatkę
+UniformBuffers* uniformBuffers = nullptr;
+
+// Rysowania aut sortowane po stanie GL (program, tekstura, VAO, głębokość)
+RenderQueue renderQueue;
+
+// Instancje aut (macierz stanowiska + lakier) i wszystkie tekstury w tablicach według klasy rozmiaru
+InstanceBuffer* instanceBuffer = nullptr;
+TextureLibrary* textureLibrary = nullptr;
+
+// Warianty shader.vert + shader.frag według cech materiału; do czasu skompilowania rysuje wariant zastępczy (kolor)
+ShaderVariants* shaderVariants = nullptr;
+const uint32_t FLOOR_SHADER = SHADER_TEXTURED | SHADER_TILING;
+const uint32_t FALLBACK_SHADER = 0;
+
+// GL 4.3: auta przez glMultiDrawElementsIndirect (dane rysowań i instancje z SSBO); "--no-mdi" wymusza ścieżkę 3.3
+ShaderVariants* mdiVariants = nullptr;
+IndirectBuffers* indirectBuffers = nullptr;
+bool noMdi = false;
+// "--no-shader-cache": programy zawsze ze źródeł, bez binarek z shaders/cache/ (ProgramCache)
+bool noShaderCache = false;
+
+// Siatki instancji aut poza frustumem (stanowiska odrzuca wcześniej CarResidency)
+FrustumCuller meshCuller;
+unsigned int culledMeshDraws = 0; // siatki pominięte w całości (żadna instancja nie widoczna)
+
+// Auta zasłonięte przez bliższe (programowy bufor głębokości); "--no-occlusion" albo 'k' wyłącza
+OcclusionCuller* occlusionCuller = nullptr;
+bool useOcclusion = true;
+
+// Reflektory nad stanowiskami i listwy przy krawędziach salonu - przypisywane do klastrów co klatkę
+ClusteredLights* clusteredLights = nullptr;
+
+CarResidency* residency = nullptr;       // stanowiska aut: wczytywanie po zbliżeniu, zwalnianie po budżecie
+Mesh*         proxyBox  = nullptr;       // pudełko jednostkowe - pośrednik auta, które jeszcze się ładuje
+
+ThreadPool*      loaderPool      = nullptr;
+ModelLoader*     modelLoader     = nullptr;
+TextureStreamer* textureStreamer = nullptr;
+
+// Konfiguracja (układ rzędów i liczba modeli - ShowroomLayout.h)
+int slotCount = CAR_COUNT;       // "--slots=N" - ile stanowisk w salonie
+int onlyCar = 0;                 // "--car=N"   - wszystkie stanowiska to car-N (w różnych lakierach)
+size_t gpuBudgetMB = 512;        // "--vram-mb=N" - budżet pamięci GPU na auta
+size_t cpuBudgetMB = 1024;       // "--ram-mb=N"  - budżet pamięci CPU na auta
+float floorScale = 1.0f;         // podłoga rośnie razem z liczbą rzędów
+const double UPLOAD_BUDGET_MS = 4.0;  // Ile czasu klatki wolno poświęcić na wysyłanie siatek na GPU
+const double TEXTURE_BUDGET_MS = 2.0; // ...i na wysyłanie tekstur przez PBO
 
 void setupFloor() {
     // Podłoga 20x20
@@ -107,7 +127,7 @@ void setupFloor() {
 
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
-    glBindVertexArray(VAO);
+    GeometryArena::bindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
@@ -144,6 +164,56 @@ void doMovement() {
     cameraPos.y = PLAYER_HEIGHT;
 }
 
+// Pudełko [0,1]^3 z normalnymi ścian - skalowane do AABB auta przez macierz modelu
+void setupProxyBox() {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    for(int axis = 0; axis < 3; axis++) {
+        for(int side = 0; side < 2; side++) {
+            glm::vec3 normal(0.0f);
+            normal[axis] = side ? 1.0f : -1.0f;
+            int u = (axis + 1) % 3, v = (axis + 2) % 3;
+            unsigned int first = static_cast<unsigned int>(vertices.size());
+            for(int corner = 0; corner < 4; corner++) {
+                Vertex vertex;
+                vertex.Position = glm::vec3(0.0f);
+                vertex.Position[axis] = static_cast<float>(side);
+                vertex.Position[u] = static_cast<float>(corner & 1);
+                vertex.Position[v] = static_cast<float>(corner >> 1);
+                vertex.Normal = normal;
+                vertex.TexCoords = glm::vec2(0.0f);
+                vertices.push_back(vertex);
+            }
+            // Kolejność wierzchołków bez znaczenia - GL_CULL_FACE jest wyłączony
+            unsigned int quad[6] = { 0, 1, 3, 0, 3, 2 };
+            for(unsigned int q : quad) indices.push_back(first + q);
+        }
+    }
+    proxyBox = new Mesh(vertices, indices, std::vector<Texture>());
+}
+
+// Stanowiska w rzędach po ROW_LENGTH, wyśrodkowane na X=0; każde auto ma swój car_paint_X.jpg,
+// a przy "--car=N" wszystkie stanowiska to ten sam model w kolejnych lakierach (instancje)
+void setupSlots() {
+    for(int i = 0; i < slotCount; i++) {
+        int modelNumber = onlyCar > 0 ? onlyCar : i % CAR_COUNT + 1;
+        int paintLayer = onlyCar > 0 ? i % CAR_COUNT : modelNumber - 1;
+
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::translate(model, slotPosition(i, slotCount));
+        model = glm::scale(model, glm::vec3(2.0f));
+        residency->addSlot("models/car-" + std::to_string(modelNumber) + ".obj", paintLayer, model);
+    }
+    floorScale = floorScaleFor(slotCount);
+}
+
+void setupLights() {
+    std::vector<glm::vec3> slotPositions;
+    for(const CarResidency::Slot &slot : residency->slots()) slotPositions.push_back(glm::vec3(slot.transform[3]));
+    clusteredLights->setLights(showroomLights(slotPositions, 10.0f * floorScale));
+    std::cout << "Swiatel w salonie: " << clusteredLights->sceneLights().size() << " (" << slotPositions.size() << " reflektorow)" << std::endl;
+}
+
 void display() {
     float currentFrame = glutGet(GLUT_ELAPSED_TIME) / 1000.0f;
     deltaTime = currentFrame - lastFrame;
@@ -154,113 +224,155 @@ void display() {
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    ourShader->use();
-
-    ourShader->setVec3("lightPos", 0.0f, 20.0f, 0.0f); 
-    ourShader->setVec3("viewPos", cameraPos.x, cameraPos.y, cameraPos.z);
-    ourShader->setVec3("lightColor", 1.0f, 1.0f, 1.0f);
-
     glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
-    glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)windowWidth / (float)windowHeight, 0.1f, 100.0f);
-    
-    ourShader->setMat4("view", view);
-    ourShader->setMat4("projection", projection);
-
-    // --- RYSOWANIE PODŁOGI ---
-    glm::mat4 model = glm::mat4(1.0f);
-    ourShader->setMat4("model", model);
-    ourShader->setInt("useTexture", 1);
-    ourShader->setInt("texture1", 0);
-    ourShader->setFloat("tiling", 10.0f); // Gęsta podłoga
-    ourShader->setVec3("objectColor", 1.0f, 1.0f, 1.0f);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, floorTexture);
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-
-    // --- RYSOWANIE SAMOCHODÓW W PĘTLI ---
-    // Obliczamy pozycję startową, żeby środkowe auto było na środku (X=0)
-    float startX = -((CAR_COUNT - 1) * carSpacing) / 2.0f;
-
-    for(int i = 0; i < carModels.size(); i++) {
-        model = glm::mat4(1.0f);
-        float xPos = startX + (i * carSpacing);
-        model = glm::translate(model, glm::vec3(xPos, 0.65f, 0.0f)); 
-        model = glm::scale(model, glm::vec3(2.0f)); 
-
-        ourShader->setMat4("model", model);
-
-        Model* currentCar = carModels[i];
-        unsigned int currentPaint = assignedPaints[i];
-
-        for(unsigned int j = 0; j < currentCar->meshes.size(); j++) {
-            Mesh& mesh = currentCar->meshes[j];
-            std::string name = mesh.materialName;
-            float currentTiling = 1.0f;
-            
-            ourShader->setInt("useTexture", 1);
-            ourShader->setVec3("objectColor", 1.0f, 1.0f, 1.0f); // Reset
-            glActiveTexture(GL_TEXTURE0);
-
-            // =========================================================
-            // METODA 1: AUTO NR 1 (SKINOWANIE / UV MAPPING)
-            // =========================================================
-            if (i == 0) {
-                // To jest Car 1. Ma dedykowaną teksturę car_paint_1.jpg
-                // Nakładamy ją na wszystko, chyba że trafimy na oponę.
-                
-                if(name.find("Glass") != std::string::npos) {
-                    // Opony nadal chcemy gumowe
-                    glBindTexture(GL_TEXTURE_2D, glassTexture);
-                    currentTiling = 1.0f;
-                } else {
-                    glBindTexture(GL_TEXTURE_2D, currentPaint);
-                    currentTiling = 1.0f;
-                }
+    const float fov = glm::radians(45.0f);
+    const float aspect = (float)windowWidth / (float)windowHeight;
+    glm::mat4 projection = glm::perspective(fov, aspect, 0.1f, 100.0f);
+    // Ile pikseli zajmuje 1 metr w odległości 1 metra - do wyboru LOD
+    float lodProjectionScale = windowHeight / (2.0f * std::tan(fov * 0.5f));
+
+    FrameUniforms frame;
+    frame.view = view;
+    frame.projection = projection;
+    frame.viewProjection = projection * view;
+    frame.lightPos = glm::vec4(0.0f, 20.0f, 0.0f, 1.0f);
+    frame.viewPos = glm::vec4(cameraPos, 1.0f);
+    frame.lightColor = glm::vec4(0.7f); // resztę dokładają reflektory salonu
+    // Światła do klastrów tej kamery (plastry między wątkiem renderującym a pulą), potem skale dla shadera
+    clusteredLights->assign(view, fov, aspect, 0.1f, 100.0f);
+    clusteredLights->fillFrame(frame, windowWidth, windowHeight);
+    uniformBuffers->setFrame(frame);
+
+    // Auta wczytane w tle wskakują na stanowiska ("pop-in"), dalekie wypadają po przekroczeniu budżetu
+    residency->update(cameraPos, frame.viewProjection, UPLOAD_BUDGET_MS);
+    if(useOcclusion) residency->updateOcclusion(*occlusionCuller, frame.viewProjection);
+    else residency->clearOcclusion();
+    textureStreamer->pump(TEXTURE_BUDGET_MS);
+
+    // --- DANE RYSOWAŃ: podłoga przez pierścień DrawData, auta zbiera kolejka (wysyła je w submit) ---
+    DrawUniforms draw;
+    draw.objectColor = glm::vec4(1.0f);
+    draw.posOffset = glm::vec4(0.0f); // podłoga ma zwykłe floaty
+    draw.posScale = glm::vec4(1.0f);
+    draw.compactVertex = 0;
+    draw.instanced = 0;
+
+    // Podłoga
+    draw.setModel(glm::scale(glm::mat4(1.0f), glm::vec3(floorScale, 1.0f, floorScale)));
+    draw.tiling = 10.0f * floorScale; // Gęsta podłoga
+    draw.textureRef = floorTextureRef;
+    size_t floorUniforms = uniformBuffers->push(draw);
+    uniformBuffers->upload();
+
+    // Auta rysuje shader_mdi.vert, jeśli kontekst ma GL 4.3; wariant programu wybrał materiał przy wczytywaniu
+    ShaderVariants* carVariants = indirectBuffers ? mdiVariants : shaderVariants;
+
+    // Auta: jedna partia instancji na model (stanowiska z tym samym car-N), kolejka sortuje siatki.
+    // Modele jeszcze w drodze - szare pudełka w wymiarach auta, wszystkie jedną partią.
+    std::vector<CarResidency::Slot> &slots = residency->slots();
+    std::vector<CarResidency::Car> &cars = residency->cars();
+    // Widoczne stanowiska każdego wczytanego auta
+    std::vector<std::vector<const CarResidency::Slot*>> carSlots(cars.size());
+    for(const CarResidency::Slot &slot : slots)
+        if(slot.visible && !slot.occluded && cars[slot.car].visible && cars[slot.car].state == CarResidency::State::Resident)
+            carSlots[slot.car].push_back(&slot);
+
+    // Każda siatka każdej widocznej instancji vs frustum - całość jednym przebiegiem SIMD
+    meshCuller.clear();
+    for(size_t c = 0; c < cars.size(); c++)
+        for(const CarResidency::Slot* slot : carSlots[c])
+            for(const Mesh &mesh : cars[c].model->meshes)
+                meshCuller.push(slot->transform, mesh.boundsMin, mesh.boundsMax, mesh.sphereCenter, mesh.sphereRadius);
+    meshCuller.cull(Frustum::fromMatrix(frame.viewProjection));
+    culledMeshDraws = 0;
+
+    size_t cullIndex = 0;
+    for(size_t c = 0; c < cars.size(); c++) {
+        CarResidency::Car &car = cars[c];
+        if(carSlots[c].empty()) continue;
+        size_t meshCount = car.model->meshes.size();
+        size_t carCullBase = cullIndex;
+        cullIndex += carSlots[c].size() * meshCount;
+
+        // Wspólna partia: wszystkie widoczne stanowiska; siatki z odrzuconymi instancjami dostają własną
+        size_t firstInstance = instanceBuffer->size();
+        for(const CarResidency::Slot* slot : carSlots[c])
+            instanceBuffer->push(InstanceData::make(slot->transform, static_cast<float>(paintTextureRefs[slot->paintLayer])));
+        unsigned int instanceCount = static_cast<unsigned int>(instanceBuffer->size() - firstInstance);
+
+        // LOD całej partii według najbliższego widocznego stanowiska
+        const CarResidency::Slot &nearest = slots[car.nearestVisibleSlot];
+        car.model->selectLods(nearest.transform, cameraPos, lodProjectionScale);
+
+        // Klasa i tiling każdej siatki są ustalone przy wczytywaniu (models/materials.txt)
+        for(size_t m = 0; m < meshCount; m++) {
+            Mesh &mesh = car.model->meshes[m];
+            size_t meshFirst = firstInstance;
+            unsigned int meshInstances = 0;
+            for(size_t s = 0; s < carSlots[c].size(); s++)
+                meshInstances += meshCuller.visible(carCullBase + s * meshCount + m) ? 1 : 0;
+            if(meshInstances == 0) {
+                culledMeshDraws++;
+                continue;
             }
-            // =========================================================
-            // METODA 2: AUTA NR 2-5 (MATERIAL MAPPING / TILING)
-            // =========================================================
-            else {
-                // Tutaj sprawdzamy nazwy materiałów i dobieramy teksturę
-
-                // 1. Opony
-                if(name.find("Black") != std::string::npos || 
-                   name.find("Tire") != std::string::npos  || 
-                   name.find("Rubber") != std::string::npos) {
-                    glBindTexture(GL_TEXTURE_2D, tireTexture);
-                }
-                // 2. Stal / Chrom
-                else if(name.find("steel") != std::string::npos || 
-                        name.find("Chrome") != std::string::npos) {
-                    glBindTexture(GL_TEXTURE_2D, steelTexture);
-                }
-                // 3. Czerwone światła
-                else if(name.find("Red") != std::string::npos) {
-                    glBindTexture(GL_TEXTURE_2D, redTexture);
-                }
-                // 4. Jasne światła
-                else if(name.find("Light") != std::string::npos) {
-                    glBindTexture(GL_TEXTURE_2D, lightTexture);
-                }
-                // 5. Szyby
-                else if(name.find("glass") != std::string::npos || 
-                        name.find("Window") != std::string::npos) {
-                    glBindTexture(GL_TEXTURE_2D, glassTexture);
-                }
-                // 6. Karoseria (wszystko inne)
-                else {
-                    glBindTexture(GL_TEXTURE_2D, currentPaint);
-                    currentTiling = 4.0f; // Powtarzamy teksturę lakieru (ziarno)
+            if(meshInstances < instanceCount) {
+                meshFirst = instanceBuffer->size();
+                for(size_t s = 0; s < carSlots[c].size(); s++) {
+                    if(!meshCuller.visible(carCullBase + s * meshCount + m)) continue;
+                    const CarResidency::Slot* slot = carSlots[c][s];
+                    instanceBuffer->push(InstanceData::make(slot->transform, static_cast<float>(paintTextureRefs[slot->paintLayer])));
                 }
             }
 
-            ourShader->setFloat("tiling", currentTiling);
-            mesh.Draw(*ourShader);
+            DrawUniforms part = draw;
+            part.setModel(glm::mat4(1.0f));
+            part.posOffset = glm::vec4(mesh.positionOffset(), 0.0f);
+            part.posScale = glm::vec4(mesh.positionScale(), 0.0f);
+            part.tiling = mesh.material.tiling;
+            part.compactVertex = mesh.compact ? 1 : 0;
+            part.instanced = 1;
+            // Tekstura materiału numerem w bibliotece (lakier z instancji) - bez bindowania tekstur
+            part.textureRef = materialTextureRefs[static_cast<int>(mesh.material.materialClass)];
+            renderQueue.push(RenderQueue::Pass::Opaque, &mesh, &carVariants->get(mesh.material.shaderFeatures),
+                             part, car.distance, meshFirst, meshInstances);
         }
     }
 
+    size_t firstProxy = instanceBuffer->size();
+    float proxyDistance = std::numeric_limits<float>::max();
+    for(const CarResidency::Slot &slot : slots) {
+        const CarResidency::Car &car = cars[slot.car];
+        if(!slot.visible || slot.occluded || car.state == CarResidency::State::Resident || car.state == CarResidency::State::Failed) continue;
+        glm::mat4 box = glm::scale(glm::translate(slot.transform, car.boundsMin), car.boundsMax - car.boundsMin);
+        instanceBuffer->push(InstanceData::make(box, 0.0f));
+        proxyDistance = std::min(proxyDistance, slot.distance);
+    }
+    if(instanceBuffer->size() > firstProxy) {
+        DrawUniforms box = draw;
+        box.setModel(glm::mat4(1.0f));
+        box.objectColor = glm::vec4(0.35f, 0.35f, 0.4f, 1.0f);
+        box.tiling = 1.0f;
+        box.instanced = 1;
+        renderQueue.push(RenderQueue::Pass::Opaque, proxyBox, &carVariants->get(0), box, proxyDistance,
+                         firstProxy, static_cast<unsigned int>(instanceBuffer->size() - firstProxy));
+    }
+    instanceBuffer->upload();
+    clusteredLights->upload();
+
+    // Tablice tekstur na stałe w jednostkach 0..2 - podłoga i auta wybierają warstwę numerem;
+    // listy świateł klastrów w jednostkach 3..5
+    textureLibrary->bind();
+    clusteredLights->bind();
+
+    // --- RYSOWANIE PODŁOGI ---
+    shaderVariants->get(FLOOR_SHADER).use();
+    uniformBuffers->bindDraw(floorUniforms);
+    GeometryArena::bindVertexArray(VAO);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+
+    // --- RYSOWANIE SAMOCHODÓW ---
+    renderQueue.submit(*uniformBuffers, *instanceBuffer, indirectBuffers);
+
     glutSwapBuffers();
     glutPostRedisplay();
 }
@@ -274,6 +386,77 @@ void keyboardDown(unsigned char key, int x, int y) {
         if(isWireframe) glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
         else glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
     }
+
+    // Porównanie z pełną siatką (najlepiej razem z 'z')
+    if(key == 'l' || key == 'L') {
+        Mesh::useLod = !Mesh::useLod;
+        std::cout << "LOD: " << (Mesh::useLod ? "wlaczone" : "wylaczone") << std::endl;
+    }
+
+    // Liczniki kolejki rysowania z ostatniej klatki; 'o' przełącza sortowanie (porównanie)
+    if(key == 'r' || key == 'R') {
+        const RenderQueue::Stats &stats = renderQueue.stats();
+        std::cout << "Kolejka (" << (RenderQueue::sorting ? "sortowana" : "bez sortowania") << (indirectBuffers ? ", MDI" : "")
+                  << "): rysowan " << stats.drawCalls << ", komend indirect " << stats.indirectCommands
+                  << ", zmian stanu " << stats.stateChanges() << " (program " << stats.programBinds << ", VAO " << stats.vertexArrayBinds
+                  << ", DrawData " << stats.uniformRangeBinds << ", instancje " << stats.instanceBinds
+                  << "), instancji " << stats.instances << std::endl;
+    }
+    if(key == 'o' || key == 'O') {
+        RenderQueue::sorting = !RenderQueue::sorting;
+        std::cout << "Sortowanie kolejki: " << (RenderQueue::sorting ? "wlaczone" : "wylaczone") << std::endl;
+    }
+
+    // Auto na środku ekranu (promień z kamery) i auto najbliższe kamerze
+    if(key == 'p' || key == 'P') {
+        float hitDistance, nearDistance;
+        int hit = residency->pick(cameraPos, cameraFront, hitDistance);
+        int nearest = residency->nearestSlot(cameraPos, nearDistance);
+        const std::vector<CarResidency::Slot> &slots = residency->slots();
+        const std::vector<CarResidency::Car> &cars = residency->cars();
+        if(hit >= 0) std::cout << "Na celowniku: stanowisko " << hit << " (" << cars[slots[hit].car].modelPath << "), " << hitDistance << " m" << std::endl;
+        else std::cout << "Na celowniku: brak auta" << std::endl;
+        if(nearest >= 0) std::cout << "Najblizej: stanowisko " << nearest << " (" << cars[slots[nearest].car].modelPath << "), " << nearDistance << " m" << std::endl;
+    }
+
+    // Odrzucanie poza frustumem w ostatniej klatce
+    if(key == 'c' || key == 'C') {
+        const FrustumCuller::Stats &slotStats = residency->cullStats();
+        const FrustumCuller::Stats &meshStats = meshCuller.stats();
+        std::cout << "Frustum: stanowiska " << slotStats.culled << "/" << slotStats.tested << " odrzucone ("
+                  << slotStats.microseconds << " us, wezlow BVH od startu " << residency->bvhNodesVisited() << "), siatki instancji " << meshStats.culled << "/" << meshStats.tested
+                  << " odrzucone (" << meshStats.microseconds << " us), pominietych rysowan siatek " << culledMeshDraws << std::endl;
+        if(useOcclusion) {
+            const OcclusionCuller::Stats &occlusion = occlusionCuller->stats();
+            std::cout << "Zasloniete: " << occlusion.occluded << "/" << occlusion.tested << " stanowisk, okluderow " << occlusion.occluders
+                      << " (" << occlusion.triangles << " trojkatow), rasteryzacja " << occlusion.rasterMicroseconds
+                      << " us, testy " << occlusion.testMicroseconds << " us" << std::endl;
+        }
+    }
+    // Oświetlenie klastrowe w ostatniej klatce
+    if(key == 'j' || key == 'J') {
+        const ClusteredLights::Stats &lights = clusteredLights->stats();
+        std::cout << "Swiatla: " << lights.visibleLights << "/" << lights.lights << " w klastrach, zajetych klastrow " << lights.occupiedClusters
+                  << "/" << ClusteredLights::CLUSTERS << ", przypisan " << lights.references << " (max " << lights.maxPerCluster
+                  << " na klaster, pominietych " << lights.overflow << "), " << lights.assignMicroseconds << " us" << std::endl;
+    }
+    if(key == 'k' || key == 'K') {
+        useOcclusion = !useOcclusion;
+        std::cout << "Odrzucanie zaslonietych aut: " << (useOcclusion ? "wlaczone" : "wylaczone") << std::endl;
+    }
+
+    // Liczniki uniformów od poprzedniego wciśnięcia - w stałym stanie 0 zapytań o lokalizacje
+    if(key == 'u' || key == 'U') {
+        static uint64_t lastQueries = 0, lastUploads = 0, lastSkipped = 0, lastDraws = 0;
+        std::cout << "Uniformy: glGetUniformLocation " << Shader::locationQueries - lastQueries
+                  << ", wyslane " << Shader::uniformUploads - lastUploads
+                  << ", pominiete (bez zmiany) " << Shader::skippedUploads - lastSkipped
+                  << ", rysowan przez DrawData " << uniformBuffers->drawCount() - lastDraws << std::endl;
+        lastQueries = Shader::locationQueries;
+        lastUploads = Shader::uniformUploads;
+        lastSkipped = Shader::skippedUploads;
+        lastDraws = uniformBuffers->drawCount();
+    }
 }
 
 void keyboardUp(unsigned char key, int x, int y) {
@@ -321,7 +504,34 @@ void resize(int width, int height) {
 }
 
 int main(int argc, char** argv) {
+    // Tryb offline: "SalonApp --bake" piecze models/car-N.obj do car-N.bin,
+    // tekstury z textures/ do .ktx (warstwy TextureLibrary: BC1 w rozmiarze klasy + mipmapy) i kończy
+    if(argc > 1 && std::strcmp(argv[1], "--bake") == 0) {
+        bool ok = true;
+        for(int i = 1; i <= CAR_COUNT; i++)
+            ok = Model::bake("models/car-" + std::to_string(i) + ".obj") && ok;
+        for(const auto &entry : std::filesystem::directory_iterator("textures")) {
+            std::string ext = entry.path().extension().string();
+            if(ext == ".jpg" || ext == ".png")
+                ok = TextureLibrary::bake("textures/" + entry.path().filename().string()) && ok;
+        }
+        return ok ? 0 : 1;
+    }
+
     glutInit(&argc, argv);
+
+    // "--compact": kwantyzowane wierzchołki (16 B zamiast 32 B)
+    for(int i = 1; i < argc; i++) {
+        if(std::strcmp(argv[i], "--compact") == 0) Mesh::useCompactVertices = true;
+        else if(std::strncmp(argv[i], "--slots=", 8) == 0) slotCount = std::max(1, std::atoi(argv[i] + 8));
+        else if(std::strncmp(argv[i], "--car=", 6) == 0) onlyCar = std::min(std::max(1, std::atoi(argv[i] + 6)), CAR_COUNT);
+        else if(std::strncmp(argv[i], "--vram-mb=", 10) == 0) gpuBudgetMB = std::strtoul(argv[i] + 10, nullptr, 10);
+        else if(std::strncmp(argv[i], "--ram-mb=", 9) == 0) cpuBudgetMB = std::strtoul(argv[i] + 9, nullptr, 10);
+        else if(std::strcmp(argv[i], "--no-mdi") == 0) noMdi = true;
+        else if(std::strcmp(argv[i], "--no-occlusion") == 0) useOcclusion = false;
+        else if(std::strcmp(argv[i], "--no-shader-cache") == 0) noShaderCache = true;
+    }
+
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA | GLUT_DEPTH);
     glutInitWindowSize(windowWidth, windowHeight);
     glutCreateWindow("Salon 3D - Spacer PwAG"); // Tytuł zgodny z dokumentem
@@ -329,32 +539,76 @@ int main(int argc, char** argv) {
     if (!gladLoadGL()) return -1;
     glEnable(GL_DEPTH_TEST);
 
-    ourShader = new Shader("shaders/shader.vert", "shaders/shader.frag");
+    // Zlinkowane programy z shaders/cache/ zamiast kompilacji przy każdym starcie
+    if(!noShaderCache) ProgramCache::init();
+    loadParallelShaderCompile();
+    std::cout << "Cache binarek programow: " << (ProgramCache::enabled ? "wlaczony" : "wylaczony") << std::endl;
+
+    uniformBuffers = new UniformBuffers();
+    // Każdy nowy wariant: bloki UBO i jednostki samplerów (w wariancie bez tekstury setInt nic nie robi)
+    auto setupVariant = [](Shader &shader) {
+        UniformBuffers::attach(shader);
+        shader.use();
+        for(int c = 0; c < TextureLibrary::SIZE_CLASSES; c++)
+            shader.setInt(UniformName(TextureLibrary::SAMPLERS[c]), c);
+        for(int i = 0; i < 3; i++)
+            shader.setInt(UniformName(ClusteredLights::SAMPLERS[i]), ClusteredLights::FIRST_UNIT + i);
+    };
+    shaderVariants = new ShaderVariants("shaders/shader.vert", "shaders/shader.frag", setupVariant, FALLBACK_SHADER);
+
+    if(!noMdi && loadMultiDrawIndirect()) {
+        mdiVariants = new ShaderVariants("shaders/shader_mdi.vert", "shaders/shader.frag", setupVariant, FALLBACK_SHADER);
+        indirectBuffers = new IndirectBuffers();
+    }
+    std::cout << "Rysowanie aut: " << (indirectBuffers ? "glMultiDrawElementsIndirect (GL 4.3)" : "glDraw* na siatke (GL 3.3)") << std::endl;
+
+    // Wszystkie warianty (podłoga, reguły materiałów) zlecone od razu - sterownik kompiluje je w tle,
+    // gdy wczytują się tekstury i auta; brak kompilacji, gdy auto wskoczy na stanowisko
+    materialRules.load("models/materials.txt");
+    Model::materialRules = &materialRules;
+    auto submitStart = std::chrono::steady_clock::now();
+    ShaderVariants* carVariants = mdiVariants ? mdiVariants : shaderVariants;
+    shaderVariants->request(FLOOR_SHADER);
+    for(uint32_t features : materialRules.shaderFeatures()) carVariants->request(features);
+    std::cout << "Zlecono " << shaderVariants->size() + (mdiVariants ? mdiVariants->size() : 0) << " programow w "
+              << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - submitStart).count() << " ms"
+              << (parallelShaderCompile ? " (kompilacja rownolegla, KHR_parallel_shader_compile)" : " (bez KHR_parallel_shader_compile)") << std::endl;
 
     setupFloor();
 
-    floorTexture = loadTexture("textures/floor.png");
-    tireTexture  = loadTexture("textures/tire_texture.jpg");
-    steelTexture = loadTexture("textures/steel_texture.jpg");
-    glassTexture = loadTexture("textures/glass_texture.jpg");
-    redTexture   = loadTexture("textures/red_texture.jpg");
-    lightTexture = loadTexture("textures/light_texture.jpg");
-
-    std::cout << "Ladowanie 5 samochodow..." << std::endl;
-    for(int i = 1; i <= CAR_COUNT; i++) {
-        std::string modelPath = "models/car-" + std::to_string(i) + ".obj";
-        // UWAGA: Każde auto dostaje swój car_paint_X.jpg
-        std::string texPath = "textures/car_paint_" + std::to_string(i) + ".jpg";
-        
-        std::cout << "Ladowanie: " << modelPath << std::endl;
-        
-        Model* newCar = new Model(modelPath);
-        carModels.push_back(newCar);
-        
-        // Ładujemy dedykowaną teksturę
-        unsigned int paintID = loadTexture(texPath.c_str());
-        assignedPaints.push_back(paintID);
-    }
+    // Wspólna pula wątków: import modeli i dekodowanie tekstur
+    loaderPool = new ThreadPool();
+    textureStreamer = new TextureStreamer(*loaderPool);
+    occlusionCuller = new OcclusionCuller(loaderPool);
+    clusteredLights = new ClusteredLights(loaderPool);
+    // Tekstury aut idą z TextureLibrary (MaterialRules), więc te z .mtl nie są nawet wczytywane
+    Model::materialTextures = false;
+
+    // Podłoga, materiały i lakiery (numer N-1 = textures/car_paint_N.jpg) - jedna biblioteka tablic
+    textureLibrary = new TextureLibrary(*textureStreamer);
+    floorTextureRef = textureLibrary->add("textures/floor.png");
+    materialTextureRefs[static_cast<int>(MaterialClass::Tire)]  = textureLibrary->add("textures/tire_texture.jpg");
+    materialTextureRefs[static_cast<int>(MaterialClass::Steel)] = textureLibrary->add("textures/steel_texture.jpg");
+    materialTextureRefs[static_cast<int>(MaterialClass::Red)]   = textureLibrary->add("textures/red_texture.jpg");
+    materialTextureRefs[static_cast<int>(MaterialClass::Light)] = textureLibrary->add("textures/light_texture.jpg");
+    materialTextureRefs[static_cast<int>(MaterialClass::Glass)] = textureLibrary->add("textures/glass_texture.jpg");
+    for(int i = 1; i <= CAR_COUNT; i++)
+        paintTextureRefs.push_back(textureLibrary->add("textures/car_paint_" + std::to_string(i) + ".jpg"));
+    textureLibrary->load();
+
+    // Warianty, które już zdążyły się skompilować; pozostałe przygotuje get(), gdy będą gotowe
+    shaderVariants->poll();
+    if(mdiVariants) mdiVariants->poll();
+    instanceBuffer = new InstanceBuffer();
+
+    // Auta ładują się w tle, gdy kamera podejdzie - podłoga rysuje się od razu,
+    // a w miejscu każdego auta stoi pudełko, dopóki auto nie będzie gotowe
+    std::cout << "Stanowisk: " << slotCount << ", budzet GPU " << gpuBudgetMB << " MB, CPU " << cpuBudgetMB << " MB" << std::endl;
+    modelLoader = new ModelLoader(*loaderPool);
+    residency = new CarResidency(*modelLoader, gpuBudgetMB * 1024 * 1024, cpuBudgetMB * 1024 * 1024);
+    setupSlots();
+    setupLights();
+    setupProxyBox();
     
     glutDisplayFunc(display);
     glutReshapeFunc(resize);
@@ -373,8 +627,21 @@ int main(int argc, char** argv) {
 
     glutMainLoop();
 
-    delete ourShader;
-    for(auto car : carModels) delete car;
+    // Najpierw pula (kończy zadania importu), potem loader, do którego te zadania się odwołują
+    delete loaderPool;
+    delete occlusionCuller;
+    delete clusteredLights;
+    delete residency;
+    delete proxyBox;
+    delete modelLoader;
+    delete textureStreamer;
+    delete instanceBuffer;
+    delete textureLibrary;
+    delete uniformBuffers;
+    delete indirectBuffers;
+    delete mdiVariants;
+    delete shaderVariants;
+    GeometryArena::releaseAll();
 
     return 0;
 }
\ No newline at end of file